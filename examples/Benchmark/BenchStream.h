@@ -0,0 +1,37 @@
+//In memory Stream used by the Commander benchmark
+//The input side replays a line a set number of times, the output side counts bytes and throws them away
+#ifndef BenchStream_h
+#define BenchStream_h
+
+#include <Arduino.h>
+
+class BenchStream : public Stream {
+public:
+  void load(const char* line, uint32_t repeats){
+    text = line;
+    textLength = strlen(line);
+    remaining = (uint32_t)textLength * repeats;
+    pos = 0;
+  }
+  int available()                          { return remaining > 0x7FFF ? 0x7FFF : (int)remaining; }
+  int peek()                               { return remaining ? text[pos] : -1; }
+  int read(){
+    if(!remaining) return -1;
+    remaining--;
+    char c = text[pos++];
+    if(pos == textLength) pos = 0;
+    return c;
+  }
+  size_t write(uint8_t b)                  { bytesOut++; return 1; }
+  size_t write(const uint8_t *buf, size_t size) { bytesOut += size; return size; }
+  void flush() {}
+  using Print::write;
+  uint32_t bytesOut = 0;
+private:
+  const char* text = "";
+  uint16_t textLength = 0;
+  uint16_t pos = 0;
+  uint32_t remaining = 0;
+};
+
+#endif
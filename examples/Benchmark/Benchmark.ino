@@ -0,0 +1,104 @@
+/*Commander example - benchmark
+ * Times the parts of Commander that run for every command: update() with matching hits and misses,
+ * the getInt, getFloat and getString parsers, quickSet and printCommandList.
+ * Each test feeds the same line to Commander many times from an in-memory Stream and prints the
+ * average time per line in microseconds, for several command table and line lengths.
+ * Run it before and after a change to the library to see what the change did.
+ * Results go to Serial as tab separated columns so they can be pasted into a spreadsheet.
+ */
+#include <Commander.h>
+#include "BenchStream.h"
+
+#define BENCH_BUFFER 128 //command buffer size, the longest test line fills it
+
+#if defined (__AVR__)
+  const uint16_t tableSizes[] = {10, 25, 50};
+  const uint16_t repeats = 100;
+#else
+  const uint16_t tableSizes[] = {10, 50, 100, 255}; //255 is the most commands a list can hold
+  const uint16_t repeats = 1000;
+#endif
+const uint16_t lineLengths[] = {16, 64, BENCH_BUFFER - 2};
+
+Commander cmd(BENCH_BUFFER);
+BenchStream bench;
+char lineBuffer[BENCH_BUFFER];
+uint16_t lastLineLength = 0;
+
+//SETUP ---------------------------------------------------------------------------
+void setup() {
+  Serial.begin(115200);
+  while(!Serial){;}
+  Serial.println("Commander benchmark");
+  Serial.println("test\tcommands\tline\tus/line");
+  for(uint8_t n = 0; n < sizeof(tableSizes)/sizeof(tableSizes[0]); n++){
+    if(!buildCommands(tableSizes[n])){
+      Serial.println("Not enough memory for the command table");
+      break;
+    }
+    cmd.begin(&bench, benchCommands, tableSizes[n] * sizeof(commandList_t));
+    cmd.errorMessages(ON);
+    runTests(tableSizes[n]);
+  }
+  Serial.println("Done");
+}
+
+//MAIN LOOP ---------------------------------------------------------------------------
+void loop() {
+}
+
+//BENCHMARKS ---------------------------------------------------------------------------
+void runTests(uint16_t tableSize){
+  //match the last generated command, then a command that is not in the list
+  sprintf(lineBuffer, "cmd%03u\n", tableSize - 1);
+  report("update hit", tableSize, timeLine(lineBuffer));
+  report("update miss", tableSize, timeLine("nosuchcommand\n"));
+  cmd.bulkRead(ON);
+  report("bulk hit", tableSize, timeLine(lineBuffer));
+  cmd.bulkRead(OFF);
+
+  for(uint8_t n = 0; n < sizeof(lineLengths)/sizeof(lineLengths[0]); n++){
+    makeLine("ints", "12345", lineLengths[n]);
+    report("getInt", tableSize, timeLine(lineBuffer));
+    makeLine("floats", "-1.25", lineLengths[n]);
+    report("getFloat", tableSize, timeLine(lineBuffer));
+    makeLine("strings", "items", lineLengths[n]);
+    report("getString", tableSize, timeLine(lineBuffer));
+  }
+  report("quickSet", tableSize, timeLine("set int1 5 int2 6 float1 1.5 float2 2.5\n"));
+
+  //printCommandList is called directly
+  unsigned long startTime = micros();
+  for(uint16_t n = 0; n < repeats; n++) cmd.printCommandList();
+  lastLineLength = 0;
+  report("printCommandList", tableSize, micros() - startTime);
+}
+
+//Feed a line to Commander 'repeats' times and return the total time taken
+unsigned long timeLine(const char* line){
+  lastLineLength = strlen(line);
+  bench.load(line, repeats);
+  unsigned long startTime = micros();
+  while(bench.available()) cmd.update();
+  return micros() - startTime;
+}
+
+//Fill lineBuffer with a command followed by copies of an item, up to the requested length
+void makeLine(const char* command, const char* item, uint16_t length){
+  strcpy(lineBuffer, command);
+  while(strlen(lineBuffer) + strlen(item) + 2 <= length){
+    strcat(lineBuffer, " ");
+    strcat(lineBuffer, item);
+  }
+  strcat(lineBuffer, "\n");
+}
+
+void report(const char* test, uint16_t tableSize, unsigned long totalTime){
+  Serial.print(test);
+  Serial.print('\t');
+  Serial.print(tableSize);
+  Serial.print('\t');
+  Serial.print(lastLineLength);
+  Serial.print('\t');
+  Serial.println((float)totalTime / repeats, 2);
+}
@@ -0,0 +1,68 @@
+//Command table for the benchmark
+//The first few commands do the parsing tests, the rest are generated names (cmd000, cmd001 ...) to fill the table
+int myInt1 = 0, myInt2 = 0;
+float myFloat1 = 0, myFloat2 = 0;
+
+const commandList_t fixedCommands[] = {
+  {"ints",    intsHandler,    "read every item with getInt"},
+  {"floats",  floatsHandler,  "read every item with getFloat"},
+  {"strings", stringsHandler, "read every item with getString"},
+  {"set",     setHandler,     "quickSet int1, int2, float1 and float2"},
+};
+const uint8_t fixedCount = sizeof(fixedCommands) / sizeof(fixedCommands[0]);
+
+commandList_t *benchCommands = NULL;
+char *commandNames = NULL;
+
+//Build a table of tableSize commands on the heap - returns false if there is not enough memory
+bool buildCommands(uint16_t tableSize){
+  free(benchCommands);
+  free(commandNames);
+  benchCommands = (commandList_t*)malloc(tableSize * sizeof(commandList_t));
+  commandNames = (char*)malloc(tableSize * 8);
+  if(benchCommands == NULL || commandNames == NULL) return false;
+  for(uint16_t n = 0; n < tableSize; n++){
+    if(n < fixedCount){
+      benchCommands[n] = fixedCommands[n];
+      continue;
+    }
+    //the generated name uses the table position so the last command is always cmdNNN where NNN = tableSize-1
+    char *name = &commandNames[n * 8];
+    sprintf(name, "cmd%03u", n);
+    benchCommands[n].commandString = name;
+    benchCommands[n].handler = emptyHandler;
+    benchCommands[n].manualString = "generated command";
+  }
+  return true;
+}
+
+//These are the command handlers
+bool emptyHandler(Commander &Cmdr){
+  return 0;
+}
+
+bool intsHandler(Commander &Cmdr){
+  int myInt = 0;
+  while(Cmdr.getInt(myInt)){;}
+  return 0;
+}
+
+bool floatsHandler(Commander &Cmdr){
+  float myFloat = 0;
+  while(Cmdr.getFloat(myFloat)){;}
+  return 0;
+}
+
+bool stringsHandler(Commander &Cmdr){
+  String myString;
+  while(Cmdr.getString(myString)){;}
+  return 0;
+}
+
+bool setHandler(Commander &Cmdr){
+  Cmdr.quickSet("int1",   myInt1);
+  Cmdr.quickSet("int2",   myInt2);
+  Cmdr.quickSet("float1", myFloat1);
+  Cmdr.quickSet("float2", myFloat2);
+  return 0;
+}
@@ -0,0 +1,33 @@
+/*Commander example - binary frames
+ * The same command handlers answer text commands and binary frames on one port.
+ * Type 'get param 3' or 'set param 3 1.25' in the terminal, or have host software send frames.
+ *
+ * Frame layout (see utilities/BinaryFrame.h):
+ *  0xA5, argument length, command ID, arguments (little endian), CRC-16/CCITT-FALSE (low byte first)
+ * The command ID is the index of the command in the command array, so 'get param' is 0 and 'set param' is 1.
+ * A 'get param' frame with no arguments replies with all the parameters as 40 floats.
+ * Turn echo off when using frames, otherwise the frame bytes are echoed back to the host.
+ */
+#include <Commander.h>
+Commander cmd;
+//Parameters the host software polls
+const uint8_t PARAMETERS = 40;
+float parameters[PARAMETERS];
+
+String deviceInfo = "#\tCommander binary frames example\n#\thttps://github.com/CreativeRobotics/Commander";
+//SETUP ---------------------------------------------------------------------------
+void setup() {
+  Serial.begin(115200);
+  for(uint8_t n = 0; n < PARAMETERS; n++) parameters[n] = n * 0.5;
+  initialiseCommander();
+  while(!Serial){;}
+  cmd.printUserString();
+  cmd.println();
+  Serial.println("Type 'help' to get help");
+  cmd.printCommandPrompt();
+}
+
+//MAIN LOOP ---------------------------------------------------------------------------
+void loop() {
+  cmd.update();
+}
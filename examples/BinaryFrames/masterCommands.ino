@@ -0,0 +1,51 @@
+//All commands for 'master'
+//COMMAND ARRAY ------------------------------------------------------------------------------
+const commandList_t masterCommands[] = {
+  {"get param",  getParamHandler,  "get a parameter"},
+  {"set param",  setParamHandler,  "set a parameter"},
+};
+
+void initialiseCommander(){
+  cmd.begin(&Serial, masterCommands, sizeof(masterCommands));
+  cmd.commandPrompt(ON); //enable the command prompt
+  cmd.echo(false);
+  //Accept binary frames - the reply frame needs room for all the parameters
+  cmd.binaryFrames(ON, PARAMETERS * sizeof(float));
+}
+
+//These are the command handlers, there needs to be one for each command in the command array myCommands[]
+bool getParamHandler(Commander &Cmdr){
+  uint8_t index = 0;
+  if(Cmdr.isBinaryFrame()){
+    //reply with one parameter if an index was sent, otherwise send them all
+    if(Cmdr.getBinary(index)){
+      if(index < PARAMETERS) Cmdr.putBinary(parameters[index]);
+    }else Cmdr.putBinary((const uint8_t*)parameters, sizeof(parameters));
+    return 0;
+  }
+  if(Cmdr.getInt(index) && index < PARAMETERS){
+    Cmdr.print("param ");
+    Cmdr.print(index);
+    Cmdr.print(" = ");
+    Cmdr.println(parameters[index], 4);
+  }else Cmdr.println("get param <0-39>");
+  return 0;
+}
+
+bool setParamHandler(Commander &Cmdr){
+  uint8_t index = 0;
+  float value = 0;
+  if(Cmdr.isBinaryFrame()){
+    //arguments are a uint8_t index and a float. The reply is empty, so it acts as an acknowledgement
+    if(Cmdr.getBinary(index) && Cmdr.getBinary(value) && index < PARAMETERS) parameters[index] = value;
+    return 0;
+  }
+  if(Cmdr.getInt(index) && Cmdr.getFloat(value) && index < PARAMETERS){
+    parameters[index] = value;
+    Cmdr.print("param ");
+    Cmdr.print(index);
+    Cmdr.print(" set to ");
+    Cmdr.println(parameters[index], 4);
+  }else Cmdr.println("set param <0-39> <value>");
+  return 0;
+}
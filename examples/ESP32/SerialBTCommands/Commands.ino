@@ -16,6 +16,10 @@ bool myFunc(Commander &Cmdr){
 void initialiseCommander(){
   cmd.begin(&SerialBT, masterCommands, sizeof(masterCommands));
   cmd.commandPrompt(ON);; //enable the command prompt
+  //Queue replies and send them a chunk at a time from update() so a slow Bluetooth client doesn't stall the loop
+  //TX_TRUNCATE drops the rest of any line that doesn't fit in the queue so the loop never waits for the client
+  cmd.transmitQueue(ON, 1024);
+  cmd.transmitPolicy(TX_TRUNCATE);
 }
 //These are the command handlers, there needs to be one for each command in the command array myCommands[]
 //The command array can have multiple commands strings that all call the same function
@@ -16,8 +16,13 @@ bool myFunc(Commander &Cmdr){
 
 //Initialisation function that avoids having to forward declare the command array and a size variable.
 void initialiseCommander(){
-  cmd.begin(&serverClient, masterCommands, sizeof(masterCommands));
-  cmd.commandPrompt(ON);; //enable the command prompt
+  //compute the command table once, then give each client its own Commander that uses it
+  masterTable.attach(masterCommands, sizeof(masterCommands));
+  for(uint8_t n = 0; n < MAX_SRV_CLIENTS; n++){
+    cmd[n].begin(&serverClients[n], masterTable);
+    cmd[n].itemTable(8); //the commands here never have more than a few items in the payload
+    cmd[n].commandPrompt(ON); //enable the command prompt
+  }
 }
 
 //These are the command handlers, there needs to be one for each command in the command array myCommands[]
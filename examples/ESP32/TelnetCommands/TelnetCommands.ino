@@ -1,10 +1,17 @@
 //This example demonstrated a commander object attached to a Wifi Telnet server
 //Use a bluetooth terminal on a smartphone or laptop to connect and enter commands.
+//Each client gets its own Commander object, and all of them share one CommandTable so the
+//command lengths and lookup index are only computed and stored once.
 
 
 #include <Commander.h>
 
-Commander cmd;
+//how many clients should be able to telnet to this ESP32
+//each extra client needs its own Commander object, command buffer and item table, only the command table is shared
+#define MAX_SRV_CLIENTS 4
+
+CommandTable masterTable;
+Commander cmd[MAX_SRV_CLIENTS];
 //Variables we can set or get
 int myInt = 0;
 float myFloat = 0.0;
@@ -13,13 +20,11 @@ float myFloat = 0.0;
 
 WiFiMulti wifiMulti;
 
-//how many clients should be able to telnet to this ESP32
-#define MAX_SRV_CLIENTS 1
 const char* ssid = "**********";
 const char* password = "**********";
 
 WiFiServer server(23);
-WiFiClient serverClient;
+WiFiClient serverClients[MAX_SRV_CLIENTS];
 
 void setup() {
   
@@ -55,7 +60,6 @@ void setup() {
   Serial.println(" 23' to connect");
   
   initialiseCommander();
-  cmd.printCommandPrompt();
 }
 
 void loop() {
@@ -64,32 +68,43 @@ void loop() {
     //check if there are any new clients
     if (server.hasClient()){
       //find free/disconnected spot
-      if (!serverClient || !serverClient.connected()){
-        if(serverClient) serverClient.stop();
-        serverClient = server.available();
-        if (!serverClient) Serial.println("available broken");
-        Serial.print("New client: ");
-        Serial.println(serverClient.remoteIP());
+      uint8_t n;
+      for(n = 0; n < MAX_SRV_CLIENTS; n++){
+        if (!serverClients[n] || !serverClients[n].connected()){
+          if(serverClients[n]) serverClients[n].stop();
+          serverClients[n] = server.available();
+          if (!serverClients[n]) Serial.println("available broken");
+          Serial.print("New client: ");
+          Serial.print(n);
+          Serial.print(' ');
+          Serial.println(serverClients[n].remoteIP());
+          cmd[n].printCommandPrompt();
+          break;
+        }
+      }
+      if(n == MAX_SRV_CLIENTS){
+        //no free spot so reject the connection
+        server.available().stop();
       }
     }
     //check clients for data
-
-    if (serverClient && serverClient.connected()){
-      if(serverClient.available()){
-        //get data from the telnet client and push it to the UART
-        
-        cmd.update();
-        //while(serverClient.available()) Serial2.write(serverClient.read());
-      }
-    } else {
-      if (serverClient) {
-        serverClient.stop();
+    for(uint8_t n = 0; n < MAX_SRV_CLIENTS; n++){
+      if (serverClients[n] && serverClients[n].connected()){
+        if(serverClients[n].available()){
+          cmd[n].update();
+        }
+      } else {
+        if (serverClients[n]) {
+          serverClients[n].stop();
+        }
       }
     }
 
   } else {
     Serial.println("WiFi not connected!");
-    if (serverClient) serverClient.stop();
+    for(uint8_t n = 0; n < MAX_SRV_CLIENTS; n++){
+      if (serverClients[n]) serverClients[n].stop();
+    }
     delay(1000);
   }
 }
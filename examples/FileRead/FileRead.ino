@@ -76,10 +76,14 @@ void loop() {
 }
 
 void readFile(){
-  //Call update for as long as there are still characters left to read
-  //cmd will return 1 when it handles a command but there is more in the buffer and 0 when it reaches the end of the file
-  while(cmd.update()){delay(10);}
-  //If there is no newline at the end of the file then any command on the last line won't be handled
-  //Add a newline to the buffer and handle any commands found there
-  cmd.endLine();
+  //Run every command in the file. runScript() reads the file in blocks, handles a last line with no newline,
+  //and doesn't print prompts or echo while it runs. Pass true as the second argument to stop at the first error
+  scriptResult_t result = cmd.runScript(myFile);
+  Serial.print("Ran ");
+  Serial.print(result.lines);
+  Serial.print(" lines in ");
+  Serial.print(result.time);
+  Serial.print("ms with ");
+  Serial.print(result.errors);
+  Serial.println(" errors");
 }
@@ -0,0 +1,27 @@
+/*Commander example - numeric opcodes
+ * Commands for machine clients that are just a number followed by a payload
+ * Try '1 2.5' to set the speed, '2' to get it, or 'hello' for a normal text command
+ * Numbers that are not in the opcode table still go to the special handler
+ */
+#include <Commander.h>
+Commander cmd;
+//Variables we can set or get
+float speed = 0.0;
+int direction = 0;
+
+String deviceInfo = "#\tCommander numeric opcodes example\n#\thttps://github.com/CreativeRobotics/Commander";
+//SETUP ---------------------------------------------------------------------------
+void setup() {
+  Serial.begin(115200);
+  initialiseCommander();
+  while(!Serial){;}
+  cmd.printUserString();
+  cmd.println();
+  Serial.println("Type 'help' to get help");
+  cmd.printCommandPrompt();
+}
+
+//MAIN LOOP ---------------------------------------------------------------------------
+void loop() {
+  cmd.update();
+}
@@ -0,0 +1,56 @@
+//All commands for 'master'
+//COMMAND ARRAY ------------------------------------------------------------------------------
+const commandList_t masterCommands[] = {
+  {"hello",      helloHandler,    "hello"},
+};
+//OPCODE ARRAY -------------------------------------------------------------------------------
+const opcodeList_t masterOpcodes[] = {
+  {1,    setSpeedHandler,      "set the speed"},
+  {2,    getSpeedHandler,      "get the speed"},
+  {3,    setDirectionHandler,  "set the direction"},
+  {4,    getDirectionHandler,  "get the direction"},
+};
+//The lookup is computed once here, so finding an opcode doesn't involve any string compares
+OpcodeTable opcodes(masterOpcodes, sizeof(masterOpcodes));
+
+void initialiseCommander(){
+  cmd.begin(&Serial, masterCommands, sizeof(masterCommands));
+  cmd.commandPrompt(ON); //enable the command prompt
+  cmd.attachOpcodes(opcodes);
+  cmd.attachSpecialHandler(numberHandler);
+}
+
+//These are the command handlers
+bool helloHandler(Commander &Cmdr){
+  Cmdr.print("Hello! this is ");
+  Cmdr.println(Cmdr.commanderName);
+  return 0;
+}
+
+//Opcode handlers are called with the payload cursor after the opcode, so the getters work as normal
+bool setSpeedHandler(Commander &Cmdr){
+  if(Cmdr.getFloat(speed)) Cmdr.println(okString);
+  return 0;
+}
+
+bool getSpeedHandler(Commander &Cmdr){
+  Cmdr.println(speed, 4);
+  return 0;
+}
+
+bool setDirectionHandler(Commander &Cmdr){
+  if(Cmdr.getInt(direction)) Cmdr.println(okString);
+  return 0;
+}
+
+bool getDirectionHandler(Commander &Cmdr){
+  Cmdr.println(direction);
+  return 0;
+}
+
+//Called for lines that start with a number that isn't an opcode
+bool numberHandler(Commander &Cmdr){
+  Cmdr.print("Unknown opcode: ");
+  Cmdr.print(Cmdr.bufferString);
+  return 0;
+}
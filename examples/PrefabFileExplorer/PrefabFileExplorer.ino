@@ -45,8 +45,12 @@ void setup() {
   //Attach the command list and the list size variable
   //tell the SD prefab what the top layer command list is called and how large it is
   setTopLayer(masterCommands, numOfMasterCmds, prompt);
-  //Attach the predefined special handler - this is required for writing files
-  cmd.attachSpecialHandler(streamToFileHandler);
+  //Attach the predefined stream handler - this is required for writing files
+  //It is passed the incoming file a block at a time. streamToFileHandler can be attached with attachSpecialHandler() instead
+  cmd.attachStreamHandler(streamToFileBlocks, FILE_BLOCK_SIZE);
+  //Sync the file to the card once a second while it is being written, and don't echo the data
+  setFileSync(SYNC_PERIODIC, 1000);
+  setFileWriteEcho(false);
   cmd.begin(&Serial, &Serial,  masterCommands, numOfMasterCmds);
   //cmd.begin(&Serial, &Serial,  fileCommands, numOfFileCmds);
   cmd.commandPrompt(ON);
@@ -7,6 +7,12 @@ int myInt = 0;
 int myInt1, myInt2;
 float myFloat1, myFloat2;
 float myFloat = 0.0;
+//'set table' can load 64 values in one line, so the command buffer is made big enough for them
+//"set table " plus 64 values of up to six characters and a space (-32768 to 32767) is 458 bytes
+#define TABLE_SIZE 64
+#define TABLE_BUFFER 512
+int table[TABLE_SIZE];
+uint16_t tableLength = 0;
 String myString1 = "";
 String myString2 = "";
 //User string - this can be anything you want, and is printed when the help and ? commands are used
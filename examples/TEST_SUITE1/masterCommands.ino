@@ -15,6 +15,7 @@ const commandList_t masterCommands[] = {
   {"set ints",    setIntsHandler,   "set up to four ints"},
   {"set floats",  setFloatsHandler, "set up to four floats"},
   {"set strings", setStringsHandler,"set up to four Strings"},
+  {"set table",   setTableHandler,  "set up to 64 table values in one go"},
   {"hidden2",     hiddenHandler,    "-Command hidden from help"},
 };
 
@@ -29,6 +30,7 @@ bool myFunc(Commander &Cmdr){
 //Initialisation function that avoids having to forward declare the command array and a size variable.
 void initialiseCommander(){
   cmd.begin(&Serial, masterCommands, sizeof(masterCommands))
+                                                            .setBuffer(TABLE_BUFFER)
                                                             .commandPrompt(ON)
                                                             .echo(true)
                                                             .errorMessages(ON)
@@ -177,6 +179,23 @@ bool setStringsHandler(Commander &Cmdr){
   return 0;
 }
 
+bool setTableHandler(Commander &Cmdr){
+  //getInts() unpacks the whole payload into an array in one pass
+  int16_t badItem;
+  tableLength = Cmdr.getInts(table, TABLE_SIZE, &badItem);
+  Cmdr.print("Loaded ");
+  Cmdr.print(tableLength);
+  Cmdr.println(" table values");
+  if(badItem >= 0){
+    //the item that stopped it is still there, so it can be read as a string
+    String badString;
+    Cmdr.getString(badString);
+    Cmdr.print("Stopped at bad value: ");
+    Cmdr.println(badString);
+  }
+  return 0;
+}
+
 bool hiddenHandler(Commander &Cmdr){
   Cmdr.println("This command is hidden from the help system");
   //Cmdr.printDiagnostics();
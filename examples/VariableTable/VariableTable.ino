@@ -0,0 +1,32 @@
+/*Commander example - variable table
+ * Variables that can be read and written by name without writing a handler for each one
+ * Try 'get speed gain', 'set speed 20 gain 1.5 enabled on' or 'dump' to print everything
+ * Values outside a variables range are clamped to it, so 'set speed 500' sets the speed to 100
+ * 'watch speed gain 100' prints both every 100ms from update(), add 'change' to only print values that have changed
+ * 'unwatch' stops them
+ */
+#include <Commander.h>
+Commander cmd;
+//Variables we can set or get
+int speed = 10;
+float gain = 0.5;
+double offset = 0.0;
+bool enabled = false;
+String label = "motor";
+
+String deviceInfo = "#\tCommander variable table example\n#\thttps://github.com/CreativeRobotics/Commander";
+//SETUP ---------------------------------------------------------------------------
+void setup() {
+  Serial.begin(115200);
+  initialiseCommander();
+  while(!Serial){;}
+  cmd.printUserString();
+  cmd.println();
+  Serial.println("Type 'help' to get help");
+  cmd.printCommandPrompt();
+}
+
+//MAIN LOOP ---------------------------------------------------------------------------
+void loop() {
+  cmd.update();
+}
@@ -0,0 +1,32 @@
+//All commands for 'master'
+//COMMAND ARRAY ------------------------------------------------------------------------------
+const commandList_t masterCommands[] = {
+  {"hello",      helloHandler,    "hello"},
+};
+//VARIABLE ARRAY -----------------------------------------------------------------------------
+//name, type, variable, and an optional min and max for numbers
+const variableList_t masterVariables[] = {
+  {"speed",    VAR_INT,    &speed,   0, 100},
+  {"gain",     VAR_FLOAT,  &gain},
+  {"offset",   VAR_DOUBLE, &offset,  -1.0, 1.0},
+  {"enabled",  VAR_BOOL,   &enabled},
+  {"label",    VAR_STRING, &label},
+};
+//The lookup is computed once here, so finding a variable doesn't involve searching the list
+VariableTable variables(masterVariables, sizeof(masterVariables));
+
+void initialiseCommander(){
+  cmd.begin(&Serial, masterCommands, sizeof(masterCommands));
+  cmd.commandPrompt(ON); //enable the command prompt
+  //the get, set and dump commands are enabled when a variable table is attached
+  cmd.attachVariables(variables);
+  //stage replies so 'dump' is written to the port in a few large blocks
+  cmd.outputBuffer(ON);
+}
+
+//These are the command handlers
+bool helloHandler(Commander &Cmdr){
+  Cmdr.print("Hello! this is ");
+  Cmdr.println(Cmdr.commanderName);
+  return 0;
+}
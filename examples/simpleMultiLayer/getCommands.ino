@@ -43,6 +43,6 @@ bool exitGet(Commander &Cmdr){
   //had over control to the sub commander
   Cmdr.println("Passing control back to main command handler");
   //transfer back to the master command list
-  Cmdr.transferBack(masterCommands, numOfMasterCmds, "Cmd");
+  Cmdr.transferBack(masterTable, "Cmd");
   return 0;
 }
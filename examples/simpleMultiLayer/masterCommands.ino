@@ -36,9 +36,9 @@ bool getHandler(Commander &Cmdr){
   //get must impliment its own function to return control, for exampe an 'exit' command.
   Cmdr.println("Passing control to get command handler");
   //Cmdr.attachCommands(getCommands, numOfGetCmds);
-  if(Cmdr.transferTo(getCommands, numOfGetCmds, "get")){
+  if(Cmdr.transferTo(getTable, "get")){
     //commander returns true if it is passing back control;
-    Cmdr.transferBack(masterCommands, numOfMasterCmds, "Cmd");
+    Cmdr.transferBack(masterTable, "Cmd");
   }
 
   //if(Cmdr.hasPayload()){
@@ -58,10 +58,10 @@ bool setHandler(Commander &Cmdr){
   //set must impliment its own function to return control, for exampe an 'exit' command.
   bool retVal = 0;
   Cmdr.println("Passing to set command handler");
-  if(Cmdr.transferTo(setCommands, numOfSetCmds, "set")){
+  if(Cmdr.transferTo(setTable, "set")){
     //Cmdr.commanderName = "set";
     //commander returns true if it is passing back control;
-    Cmdr.transferBack(masterCommands, numOfMasterCmds, "Cmd");
+    Cmdr.transferBack(masterTable, "Cmd");
   }
   return 0;
 }
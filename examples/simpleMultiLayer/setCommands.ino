@@ -48,6 +48,6 @@ bool exitSet(Commander &Cmdr){
   //had over control to the sub commander
   Cmdr.println("Passing control back to main command handler");
   //transfer back to the master command list
-  Cmdr.transferBack(masterCommands, numOfMasterCmds, "Cmd");
+  Cmdr.transferBack(masterTable, "Cmd");
   return 0;
 }
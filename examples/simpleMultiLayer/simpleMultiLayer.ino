@@ -16,6 +16,8 @@ extern const commandList_t getCommands[]; //forward declare the get command list
 extern const commandList_t setCommands[]; //forward declare the set command list
 //portSettings_t savedSettings;
 Commander cmd;
+//A precomputed table for each command list - switching layers just swaps the table, nothing is recalculated
+CommandTable masterTable, getTable, setTable;
 //Variables we can set or get
 int myInt = 0;
 float myFloat = 0.0;
@@ -23,7 +25,10 @@ float myFloat = 0.0;
 //SETUP ---------------------------------------------------------------------------
 void setup() {
   Serial.begin(115200);
-  cmd.begin(&Serial, masterCommands, numOfMasterCmds);
+  masterTable.attach(masterCommands, numOfMasterCmds);
+  getTable.attach(getCommands, numOfGetCmds);
+  setTable.attach(setCommands, numOfSetCmds);
+  cmd.begin(&Serial, masterTable);
   cmd.commanderName = "Cmd";
   cmd.commandPrompt(ON);
   cmd.echo(true);
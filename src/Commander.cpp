@@ -1,19 +1,33 @@
 #include "Commander.h"
 
+CommandTable Commander::noCommands;
+static uint8_t defaultDelimiterMap[32]; //the map for DEFAULT_DELIMITERS, shared by every Commander object that uses them
+static bool defaultDelimiterMapBuilt = false;
+const char* const Commander::internalCommandArray[INTERNAL_COMMAND_ITEMS] = { "U", "X", "?", "help", "echo", "echox", "errors", "stats", "get", "set", "dump", "watch", "unwatch"};
+
 //Initialise the array of internal commands with the constructor
 Commander::Commander(){
-	bufferString.reserve(bufferSize);
+	bufferString.setCapacity(bufferSize);
+	itemTable(COMMANDER_MAX_ITEMS);
+	buildDelimiterMap();
 	ports.settings.reg = COMMANDER_DEFAULT_REGISTER_SETTINGS;
 	commandState.reg = COMMANDER_DEFAULT_STATE_SETTINGS;
 }
 //==============================================================================================================
 Commander::Commander(uint16_t reservedBuffer){
-	//bufferString.reserve(bufferSize);
 	bufferSize = reservedBuffer;
-	bufferString.reserve(bufferSize);
+	bufferString.setCapacity(bufferSize);
+	itemTable(COMMANDER_MAX_ITEMS);
+	buildDelimiterMap();
 	ports.settings.reg = COMMANDER_DEFAULT_REGISTER_SETTINGS;
 	commandState.reg = COMMANDER_DEFAULT_STATE_SETTINGS;
 }
+//==============================================================================================================
+Commander::~Commander(){
+	if(items) delete [] items;
+	if(ownTable) delete ownTable;
+	if(delimiterMap != defaultDelimiterMap) delete [] delimiterMap;
+}
 
 //==============================================================================================================
 Commander&	Commander::begin(Stream *sPort){
@@ -39,6 +53,14 @@ Commander&	Commander::begin(Stream *sPort, Stream *oPort, const commandList_t *c
 	return *this;
 }
 //==============================================================================================================
+Commander&	Commander::begin(Stream *sPort, CommandTable& commands){
+	ports.inPort = sPort;
+	ports.outPort = sPort;
+	attachCommands(commands);
+	resetBuffer();
+	return *this;
+}
+//==============================================================================================================
 
 Commander&	 Commander::begin(const commandList_t *commands, uint32_t size){
 	ports.inPort = NULL;
@@ -50,14 +72,41 @@ Commander&	 Commander::begin(const commandList_t *commands, uint32_t size){
 //==============================================================================================================
 
 bool Commander::update(){
-	if(commandState.bit.isCommandPending) return processPending();
+	commandCount = 0;
+	return updateOnce();
+}
+//==============================================================================================================
+bool Commander::update(uint32_t budgetMicros){
+	//Keep reading and handling commands until the input is drained or the time budget runs out
+	//A command is never interrupted, so the budget can be exceeded by the time one command takes
+	uint32_t startTime = micros();
+	commandCount = 0;
+	bool moreToDo;
+	do{
+		moreToDo = updateOnce() || commandState.bit.isCommandPending;
+	}while(moreToDo && micros() - startTime < budgetMicros);
+	return moreToDo;
+}
+//==============================================================================================================
+bool Commander::updateOnce(){
+	if(ports.settings.bit.queueOutput) drainQueue(false);
+	if(watchCount) serviceWatches();
+	if(commandState.bit.isCommandPending){
+		processPending();
+		handleChain();
+		return inputAvailable();
+	}
 	if(!ports.inPort) return 0;
 	//Check if streamOn is true and process it if it is.
 	if(commandState.bit.dataStreamOn) return streamData();
 
 	commandState.bit.commandHandled = false;
 	if(ports.settings.bit.commandParserEnabled){
-		while(ports.inPort->available()){
+		//drop a binary frame that stopped part way through so the port can recover
+		if(commandState.bit.frameReceiving && millis() - frameState->startTime > FRAME_TIMEOUT) resetBuffer();
+		//after bulkRead is turned off anything left in the block is still handled before reading the port a byte at a time
+		if(ports.settings.bit.bulkRead || (readBlock && readBlock->head < readBlock->tail)) readBlocks();
+		else while(ports.inPort->available()){
 			int inByte = ports.inPort->read();
 			echoPorts(inByte);
       if(processBuffer(inByte)) break; //break out of here - an end of line or reload was found so unpack and handle the command 
@@ -73,6 +122,7 @@ bool Commander::update(){
 			//println(bufferString);
 			//printBuffer();
 			commandState.bit.commandHandled = !handleCommand(); //returns true if there was a problem
+			handleChain();
 			
 			//AutoReload
 			//if(startOfNextItem)
@@ -95,7 +145,198 @@ bool Commander::update(){
 			benchmarkCounter = 0;
 		}
 	#endif
-	return (bool)ports.inPort->available(); //return true if any bytes left to read
+	flushOutput();
+	if(ports.settings.bit.queueOutput) drainQueue(false);
+	return inputAvailable(); //return true if any bytes left to read
+}
+//==============================================================================================================
+void Commander::readBlocks(){
+	//Read the incoming stream a block at a time and process it until an end of line or reload is found.
+	//Anything after the end of line stays in the block for the next update.
+	readBlock_t &block = *readBlock;
+	while(true){
+		if(block.head == block.tail){
+			if(!ports.settings.bit.bulkRead) return; //only emptying the block after bulkRead was turned off
+			int avail = ports.inPort->available();
+			if(avail <= 0) return;
+			if(avail > block.size) avail = block.size;
+			block.tail = ports.inPort->readBytes(block.data, avail); //only ask for what is available so this never waits for the timeout
+			block.head = 0;
+			block.echoed = 0;
+			if(block.tail == 0) return;
+		}
+		//echo everything up to the next end of line in one go
+		//binary frames can turn up anywhere in the block and aren't echoed, so with binaryFrames on each byte is echoed as it is processed
+		if(block.echoed <= block.head && !ports.settings.bit.binaryFrames){
+			const uint8_t* eol = (const uint8_t*)memchr(&block.data[block.head], endOfLineCharacter, block.tail - block.head);
+			block.echoed = eol ? (eol - block.data) + 1 : block.tail;
+			echoPorts(&block.data[block.head], block.echoed - block.head);
+		}
+		while(block.head < block.tail){
+			int inByte = block.data[block.head];
+			if(block.head++ >= block.echoed) echoPorts(inByte);
+			if(processBuffer(inByte)) return; //an end of line or reload was found so unpack and handle the command
+		}
+	}
+}
+//==============================================================================================================
+Commander& Commander::bulkRead(bool state, uint16_t blockSize){
+	//enable or disable reading the input stream in blocks
+	if(state && readBlock == NULL){
+		readBlock = new readBlock_t;
+		if(readBlock == NULL) return *this;
+		readBlock->data = NULL;
+		readBlock->size = 0;
+		readBlock->head = readBlock->tail = readBlock->echoed = 0;
+	}
+	if(state && (readBlock->data == NULL || blockSize != readBlock->size)){
+		if(readBlock->head < readBlock->tail) return *this; //don't throw away data that has not been processed yet
+		if(readBlock->data) delete [] readBlock->data;
+		readBlock->data = new uint8_t[blockSize];
+		readBlock->size = readBlock->data ? blockSize : 0;
+		readBlock->head = readBlock->tail = readBlock->echoed = 0;
+	}
+	ports.settings.bit.bulkRead = state && readBlock && readBlock->data;
+	return *this;
+}
+//==============================================================================================================
+Commander& Commander::commandStats(bool state){
+	//enable or disable the per command stats. Enabling clears any stats already recorded
+	freeStats();
+	ports.settings.bit.commandStats = state;
+	if(state) selectStats();
+	return *this;
+}
+//==============================================================================================================
+void Commander::freeStats(){
+	while(statsBlocks){
+		cmdStatsBlock_t* next = statsBlocks->next;
+		delete [] statsBlocks->stats;
+		delete statsBlocks;
+		statsBlocks = next;
+	}
+	statsCurrent = NULL;
+}
+//==============================================================================================================
+void Commander::selectStats(){
+	//point statsCurrent at the stats for the current command list, adding them if this list hasn't been used before
+	statsCurrent = NULL;
+	cmdStatsBlock_t* block = statsBlocks;
+	while(block && block->list != table->commandList) block = block->next;
+	if(block && block->entries != table->commandListEntries){
+		//the list has been changed so its old stats don't match up any more
+		delete [] block->stats;
+		block->stats = NULL;
+		block->entries = 0;
+	}
+	if(block == NULL){
+		block = new cmdStatsBlock_t;
+		if(block == NULL) return;
+		block->list = table->commandList;
+		block->stats = NULL;
+		block->entries = 0;
+		block->next = statsBlocks;
+		statsBlocks = block;
+	}
+	if(block->stats == NULL && table->commandListEntries > 0){
+		block->stats = new cmdStats_t[table->commandListEntries];
+		if(block->stats) block->entries = table->commandListEntries;
+	}
+	statsCurrent = block;
+}
+//==============================================================================================================
+Commander& Commander::resetCommandStats(){
+	//clear the stats for every command list
+	for(cmdStatsBlock_t* block = statsBlocks; block; block = block->next){
+		for(uint16_t n = 0; n < block->entries; n++) block->stats[n] = cmdStats_t();
+	}
+	return *this;
+}
+//==============================================================================================================
+const cmdStats_t* Commander::getCommandStats(uint16_t commandIndex){
+	if(!ports.settings.bit.commandStats || statsCurrent == NULL || commandIndex >= statsCurrent->entries) return NULL;
+	return &statsCurrent->stats[commandIndex];
+}
+//==============================================================================================================
+bool Commander::callHandler(uint16_t cmdIdx){
+	//call a command handler from the current table, timing it if stats are enabled
+	if(!ports.settings.bit.commandStats) return table->commandList[cmdIdx].handler(*this);
+	//the handler can switch command tables or turn stats off, so only record the time if the stats it started with are still in use
+	CommandTable* handlerTable = table;
+	cmdStatsBlock_t* handlerBlock = statsCurrent;
+	cmdStats_t* handlerStats = statsCurrent ? statsCurrent->stats : NULL;
+	uint32_t handlerStart = micros();
+	bool returnVal = table->commandList[cmdIdx].handler(*this);
+	uint32_t handlerTime = micros() - handlerStart;
+	if(ports.settings.bit.commandStats && table == handlerTable && statsCurrent && statsCurrent == handlerBlock && statsCurrent->stats == handlerStats
+		 && commandIndex == (int16_t)cmdIdx && cmdIdx < statsCurrent->entries){
+		recordStats(cmdIdx, handlerTime);
+	}
+	return returnVal;
+}
+//==============================================================================================================
+void Commander::recordStats(uint16_t cmdIdx, uint32_t handlerTime){
+	cmdStats_t &stats = statsCurrent->stats[cmdIdx];
+	stats.hits++;
+	stats.totalTime += handlerTime;
+	if(handlerTime < stats.minTime) stats.minTime = handlerTime;
+	if(handlerTime > stats.maxTime) stats.maxTime = handlerTime;
+	//the bin is the number of bits in the handler time
+	uint8_t bin = 0;
+	while(handlerTime && bin < COMMAND_STATS_BINS-1){
+		handlerTime >>= 1;
+		bin++;
+	}
+	if(stats.histogram[bin] < 0xFFFF) stats.histogram[bin]++;
+}
+//==============================================================================================================
+Commander& Commander::printCommandStats(){
+	//print a line for each command that has been used: hits, min, mean and max time in us, then the histogram bins
+	write(commentCharacter);
+	if(!ports.settings.bit.commandStats){
+		println(F(" Command stats are off"));
+		return *this;
+	}
+	println(F(" Command\thits\tmin\tmean\tmax\thistogram (us: 0, 1, 2-3, 4-7 ...)"));
+	for(uint16_t n = 0; statsCurrent && n < statsCurrent->entries; n++){
+		cmdStats_t &stats = statsCurrent->stats[n];
+		if(stats.hits == 0) continue;
+		write(commentCharacter);
+		write(' ');
+		print(table->commandList[n].commandString);
+		write('\t');
+		printNumber(stats.hits);
+		write('\t');
+		printNumber(stats.minTime);
+		write('\t');
+		printNumber(stats.totalTime / stats.hits);
+		write('\t');
+		printNumber(stats.maxTime);
+		write('\t');
+		for(uint8_t b = 0; b < COMMAND_STATS_BINS; b++){
+			if(b > 0) write(',');
+			printNumber(stats.histogram[b]);
+		}
+		println();
+	}
+	return *this;
+}
+//==============================================================================================================
+bool Commander::inputAvailable(){
+	if(readBlock && readBlock->head < readBlock->tail) return true;
+	if(!ports.inPort) return false;
+	return (bool)ports.inPort->available();
+}
+//==============================================================================================================
+int Commander::readInput(){
+	//read a byte, starting with anything left over in the read block
+	if(readBlock && readBlock->head < readBlock->tail) return readBlock->data[readBlock->head++];
+	return ports.inPort->read();
+}
+//==============================================================================================================
+int Commander::peekInput(){
+	if(readBlock && readBlock->head < readBlock->tail) return readBlock->data[readBlock->head];
+	return ports.inPort->peek();
 }
 //==============================================================================================================
 bool Commander::processPending(){
@@ -107,60 +348,347 @@ bool Commander::processPending(){
 	if(ports.settings.bit.echoToAlt && ports.altPort) printAlt(bufferString);
 	commandState.bit.isCommandPending = false;
 	commandState.bit.commandHandled = !handleCommand();
-	if(!ports.inPort) return 0;
-	else return (bool)ports.inPort->available(); //return true if any bytes left to read
+	return inputAvailable(); //return true if any bytes left to read
 }
 
 bool Commander::streamData(){
-	bufferString = "";//clear the buffer so we can fill it with any new chars
+	if(streamBlock && streamBlock->handler) return streamBlocks();
+	bufferString.clear();//clear the buffer so we can fill it with any new chars
 	bytesWritten = 0;
 	commandState.bit.bufferFull = false;
 	
-	while(ports.inPort->available()){
-		int inByte = ports.inPort->read();
+	while(inputAvailable()){
+		int inByte = readInput();
 		if(inByte == EOFChar && !ports.settings.bit.dataStreamMode){
 			//println("EOF Found, tidying up");
 			commandState.bit.dataStreamOn = false;
 			//get rid of any newlines or CRs in the stream
-			while(ports.inPort->peek() == endOfLineCharacter || ports.inPort->peek() == '\r') ports.inPort->read();
+			while(peekInput() == endOfLineCharacter || peekInput() == '\r') readInput();
 			//call the handler again so it can clean up and close anything that needs closing
 			commandState.bit.commandHandled = !handleCustomCommand();
 			resetBuffer();
 			printCommandPrompt();
-			return (bool)ports.inPort->available(); //return true if any bytes left to read
+			return inputAvailable(); //return true if any bytes left to read
 		}
 		//write incoming data to the buffer
 		writeToBuffer(inByte);
 		//echo to ports if configured
 		echoPorts(inByte);
 		//call the handler if you fill the buffer, then return so everything is reset
-		if(bytesWritten == bufferSize-1 || !ports.inPort->available()) {
+		if(bytesWritten == bufferSize-1 || !inputAvailable()) {
 			
 			//println("Buffer ready, calling handler");
 			commandState.bit.commandHandled = !handleCustomCommand();
 			
 			//println("Clearing buffer");
-			bufferString = "";//clear the buffer so we can fill it with any new chars
+			bufferString.clear();//clear the buffer so we can fill it with any new chars
 			bytesWritten = 0;
 			resetBuffer();
-			return (bool)ports.inPort->available(); //return true if any bytes left to read
+			return inputAvailable(); //return true if any bytes left to read
 		}
 	}
-	return (bool)ports.inPort->available(); //return true if any bytes left to read
+	return inputAvailable(); //return true if any bytes left to read
 }
 
+//==============================================================================================================
+bool Commander::streamBlocks(){
+	//Read stream data straight into the stream block and pass it to the stream handler a chunk at a time.
+	//The block holds two chunks and they are used in turn, so the chunk passed to the handler last time stays
+	//untouched while the next one fills - the handler can keep using it (EG for a DMA or background SD write) until it is called again.
+	streamBlock_t &block = *streamBlock;
+	uint8_t* chunk = &block.data[commandState.bit.streamHalf ? block.chunk : 0];
+	uint16_t start = block.length;
+	bool endOfFile = false;
+	while(block.length < block.chunk && inputAvailable()){
+		int inByte = readInput();
+		if(inByte == EOFChar && !ports.settings.bit.dataStreamMode){
+			endOfFile = true;
+			break;
+		}
+		chunk[block.length++] = inByte;
+	}
+	if(block.length > start){
+		echoPorts(&chunk[start], block.length - start);
+		block.lastByte = millis();
+	}
+	if(endOfFile){
+		//println("EOF Found, tidying up");
+		commandState.bit.dataStreamOn = false;
+		//get rid of any newlines or CRs in the stream
+		while(peekInput() == endOfLineCharacter || peekInput() == '\r') readInput();
+		//pass the last chunk, isStreaming() is now false so the handler knows to clean up
+		passStreamChunk();
+		resetBuffer();
+		printCommandPrompt();
+		return inputAvailable();
+	}
+	//pass the chunk when it is full, or if the data has stopped arriving
+	if(block.length == block.chunk || (block.length > 0 && millis() - block.lastByte >= STREAM_IDLE_TIME)) passStreamChunk();
+	return inputAvailable(); //return true if any bytes left to read
+}
+//==============================================================================================================
+void Commander::passStreamChunk(){
+	uint8_t* chunk = &streamBlock->data[commandState.bit.streamHalf ? streamBlock->chunk : 0];
+	uint16_t length = streamBlock->length;
+	commandState.bit.streamHalf = !commandState.bit.streamHalf;
+	streamBlock->length = 0;
+	commandState.bit.commandHandled = !streamBlock->handler(*this, chunk, length);
+}
+//==============================================================================================================
+Commander& Commander::attachStreamHandler(streamHandler handler, uint16_t chunkSize){
+	//pass stream data to handler in chunks of up to chunkSize bytes. The chunk size is independent of the command buffer
+	if(streamBlock == NULL){
+		streamBlock = new streamBlock_t;
+		if(streamBlock == NULL) return *this;
+		streamBlock->data = NULL;
+		streamBlock->chunk = 0;
+		streamBlock->lastByte = 0;
+	}
+	if(streamBlock->data == NULL || chunkSize != streamBlock->chunk){
+		if(streamBlock->data) delete [] streamBlock->data;
+		streamBlock->data = new uint8_t[chunkSize * 2];
+		streamBlock->chunk = streamBlock->data ? chunkSize : 0;
+	}
+	streamBlock->length = 0;
+	streamBlock->handler = streamBlock->data ? handler : NULL;
+	return *this;
+}
+//==============================================================================================================
+size_t Commander::write(const uint8_t *buffer, size_t size){
+	//write reply data a line at a time, adding the prefix at the start and the postfix at the end of each line
+	yield();
+	if(commandState.bit.binaryFrame){
+		//text printed by a handler that was called from a binary frame goes in the reply frame
+		putBinary(buffer, size > 255 ? 255 : size);
+		return size;
+	}
+	if( ports.settings.bit.copyResponseToAlt && ports.altPort ) ports.altPort->write(buffer, size);
+	if(!ports.outPort) return 0;
+	size_t start = 0;
+	while(start < size){
+		const uint8_t* eol = (const uint8_t*)memchr(&buffer[start], '\n', size - start);
+		size_t end = eol ? (size_t)(eol - buffer) : size;
+		doPrefix();
+		sendOut(&buffer[start], end - start);
+		if(eol){
+			if(commandState.bit.postfixMessage) sendOut(postfixString);
+			sendOut(eol, 1);
+			commandState.bit.newlinePrinted = true;
+			if(ports.settings.bit.bufferOutput && !commandState.bit.holdOutput) flushOutput();
+			end++;
+		}
+		start = end;
+	}
+	return size;
+}
+//==============================================================================================================
+Commander& Commander::printInteger(int64_t value){
+	char buf[NUMBER_BUFFER_SIZE];
+	write((const uint8_t*)buf, formatInteger(buf, value));
+	return *this;
+}
+//==============================================================================================================
+Commander& Commander::printUnsigned(uint64_t value){
+	char buf[NUMBER_BUFFER_SIZE];
+	write((const uint8_t*)buf, formatUnsigned(buf, value));
+	return *this;
+}
+//==============================================================================================================
+Commander& Commander::printNumber(float value, int8_t decimals){
+	char buf[NUMBER_BUFFER_SIZE];
+	uint8_t length = decimals < 0 ? formatShortest(buf, value) : formatFixed(buf, value, decimals);
+	write((const uint8_t*)buf, length);
+	return *this;
+}
+//==============================================================================================================
+Commander& Commander::printNumber(double value, int8_t decimals){
+	char buf[NUMBER_BUFFER_SIZE];
+	uint8_t length = decimals < 0 ? formatShortest(buf, value) : formatFixed(buf, value, decimals);
+	write((const uint8_t*)buf, length);
+	return *this;
+}
+//==============================================================================================================
+void Commander::sendOut(const uint8_t* data, size_t length){
+	//write to the out port, or stage the data in the output block if bufferOutput is enabled
+	if(!ports.settings.bit.bufferOutput){
+		transmit(data, length);
+		return;
+	}
+	while(length > 0){
+		if(outBlock->length == outBlock->size) flushOutput();
+		size_t chunk = outBlock->size - outBlock->length;
+		if(chunk > length) chunk = length;
+		memcpy(&outBlock->data[outBlock->length], data, chunk);
+		outBlock->length += chunk;
+		data += chunk;
+		length -= chunk;
+	}
+}
+//==============================================================================================================
+void Commander::flushOutput(){
+	//write any staged replies to the out port
+	if(outBlock == NULL || outBlock->length == 0) return;
+	transmit(outBlock->data, outBlock->length);
+	outBlock->length = 0;
+}
+//==============================================================================================================
+void Commander::transmit(const uint8_t* data, size_t length){
+	//write to the out port, or add the data to the transmit queue if queueOutput is enabled
+	if(!ports.outPort) return;
+	if(!ports.settings.bit.queueOutput){
+		ports.outPort->write(data, length);
+		return;
+	}
+	txQueue_t &queue = *txQueue;
+	for(size_t n = 0; n < length; n++){
+		bool isEOL = (data[n] == '\n');
+		if(commandState.bit.txTruncating){
+			//truncate keeps the last byte of the queue free so the end of line fits, unless the queue was filled by an end of line
+			if(!isEOL || queue.count == queue.size){
+				queue.dropped++;
+				continue;
+			}
+			commandState.bit.txTruncating = false;
+		}else{
+			uint16_t room = queue.size - queue.count;
+			if(ports.settings.bit.txPolicy == TX_TRUNCATE && !isEOL && room > 0) room--;
+			if(room == 0){
+				if(ports.settings.bit.txPolicy == TX_BLOCK) drainQueue(true);
+				else{
+					queue.dropped++;
+					if(ports.settings.bit.txPolicy == TX_TRUNCATE) commandState.bit.txTruncating = true;
+					continue;
+				}
+			}
+		}
+		uint16_t tail = queue.head + queue.count;
+		if(tail >= queue.size) tail -= queue.size;
+		queue.data[tail] = data[n];
+		queue.count++;
+	}
+}
+//==============================================================================================================
+void Commander::drainQueue(bool all){
+	//send queued data to the out port. Unless all is true only send what the port can take without blocking
+	if(txQueue == NULL || txQueue->count == 0 || !ports.outPort) return;
+	txQueue_t &queue = *txQueue;
+	uint16_t budget = queue.count;
+	if(!all){
+		int room = ports.outPort->availableForWrite();
+		//the default availableForWrite() returns 0, and many ports (EG SoftwareSerial, BluetoothSerial, WiFi and Ethernet clients)
+		//don't override it, so 0 doesn't mean the port is full. Use the room the port reports if it does, otherwise send a small chunk
+		if(room <= 0) room = DEFAULT_TX_CHUNK;
+		if((uint16_t)room < budget) budget = room;
+	}
+	while(budget > 0){
+		//the queued data may wrap around the end of the queue so write it in up to two parts
+		uint16_t chunk = queue.size - queue.head;
+		if(chunk > budget) chunk = budget;
+		ports.outPort->write(&queue.data[queue.head], chunk);
+		queue.head += chunk;
+		if(queue.head == queue.size) queue.head = 0;
+		queue.count -= chunk;
+		budget -= chunk;
+	}
+}
+//==============================================================================================================
+Commander& Commander::transmitQueue(bool state, uint16_t queueSize){
+	//enable or disable queueing data for the out port. Anything already queued is sent first
+	flushOutput();
+	drainQueue(true);
+	if(state && txQueue == NULL){
+		txQueue = new txQueue_t;
+		if(txQueue == NULL) return *this;
+		txQueue->data = NULL;
+		txQueue->size = 0;
+		txQueue->dropped = 0;
+	}
+	if(state && (txQueue->data == NULL || queueSize != txQueue->size)){
+		if(txQueue->data) delete [] txQueue->data;
+		txQueue->data = new uint8_t[queueSize];
+		txQueue->size = txQueue->data ? queueSize : 0;
+		txQueue->head = txQueue->count = 0;
+	}
+	commandState.bit.txTruncating = false;
+	ports.settings.bit.queueOutput = state && txQueue && txQueue->data;
+	return *this;
+}
+//==============================================================================================================
+Commander& Commander::outputBuffer(bool state, uint16_t blockSize){
+	//enable or disable staging replies in a buffer so they are written to the out port in blocks
+	flushOutput();
+	if(state && outBlock == NULL){
+		outBlock = new outBlock_t;
+		if(outBlock == NULL) return *this;
+		outBlock->data = NULL;
+		outBlock->size = 0;
+		outBlock->length = 0;
+	}
+	if(state && (outBlock->data == NULL || blockSize != outBlock->size)){
+		if(outBlock->data) delete [] outBlock->data;
+		outBlock->data = new uint8_t[blockSize];
+		outBlock->size = outBlock->data ? blockSize : 0;
+	}
+	ports.settings.bit.bufferOutput = state && outBlock && outBlock->data;
+	return *this;
+}
+//==============================================================================================================
+Commander& Commander::binaryFrames(bool state, uint8_t replyBytes){
+	//enable or disable binary frames. replyBytes is the longest reply frame a handler can send
+	if(state && frameState == NULL){
+		frameState = new frameState_t;
+		if(frameState == NULL) return *this;
+		frameState->reply = NULL;
+		frameState->replySize = frameState->replyLength = 0;
+		frameState->read = frameState->end = 0;
+		frameState->startTime = 0;
+	}
+	if(state && (frameState->reply == NULL || replyBytes != frameState->replySize)){
+		if(frameState->reply) delete [] frameState->reply;
+		frameState->reply = new uint8_t[replyBytes];
+		frameState->replySize = frameState->reply ? replyBytes : 0;
+	}
+	ports.settings.bit.binaryFrames = state && frameState && frameState->reply;
+	return *this;
+}
+//==============================================================================================================
+bool Commander::getBinary(uint8_t *data, uint8_t length){
+	//copy the next length bytes of the frame arguments, returns false if there aren't enough left
+	if(!commandState.bit.binaryFrame || length > frameArgsLeft()) return false;
+	memcpy(data, bufferString.c_str() + frameState->read, length);
+	frameState->read += length;
+	return true;
+}
+//==============================================================================================================
+Commander& Commander::putBinary(const uint8_t *data, uint8_t length){
+	//add data to the reply frame, anything that doesn't fit is dropped
+	if(!commandState.bit.binaryFrame) return *this;
+	if(length > frameState->replySize - frameState->replyLength) length = frameState->replySize - frameState->replyLength;
+	memcpy(&frameState->reply[frameState->replyLength], data, length);
+	frameState->replyLength += length;
+	return *this;
+}
+//==============================================================================================================
 //Echo incoming to out and alt ports
 void Commander::echoPorts(int portByte){
-	if(ports.settings.bit.locked) return;
-	if(ports.settings.bit.echoTerminal) 							ports.outPort->write(portByte);
+	if(ports.settings.bit.locked || isFrameByte(portByte)) return;
+	uint8_t echoByte = portByte;
+	if(ports.settings.bit.echoTerminal) 							sendOut(&echoByte, 1);
 	if(ports.settings.bit.echoToAlt && ports.altPort) ports.altPort->write(portByte);
 }
+//Echo a block of incoming data to out and alt ports
+void Commander::echoPorts(const uint8_t* portData, size_t length){
+	if(ports.settings.bit.locked || length == 0) return;
+	if(ports.settings.bit.echoTerminal) 							sendOut(portData, length);
+	if(ports.settings.bit.echoToAlt && ports.altPort) ports.altPort->write(portData, length);
+}
 //==============================================================================================================
 
 //copy data between ports
 void Commander::bridgePorts(){
 	if(!ports.settings.bit.commandParserEnabled && ports.settings.bit.echoToAlt && ports.altPort){
 			//pass data between ports
+			while(readBlock && readBlock->head < readBlock->tail) ports.altPort->write(readBlock->data[readBlock->head++]);
 			while(ports.altPort->available()) ports.outPort->write(ports.altPort->read());
 			while(ports.inPort->available()) ports.altPort->write(ports.inPort->read());
 	}
@@ -175,7 +703,8 @@ bool Commander::feed(Commander& Cmdr){
 	//Feed the payload of a different commander object to this one
 	//Copy the String buffer then handle the command
 	
-	bufferString = Cmdr.getPayload();
+	if(Cmdr.getReadIndex() < Cmdr.bufferString.length()) bufferString = Cmdr.bufferString.c_str() + Cmdr.getReadIndex();
+	else bufferString.clear();
 	bool prompt = commandPrompt();
 	commandPrompt(OFF); //dsiable the prompt so it doesn't print twice
 	commandState.bit.commandHandled = !handleCommand(); //try and handle the command
@@ -215,8 +744,10 @@ String Commander::getPayloadString(){
 bool Commander::feedString(String newString){
 	//Feed a string to commander and process it - bypassing any read of the serial ports
 	if(newString.length() < 2) return commandState.bit.commandHandled; //return if string is not valid - too short for a command and endofline
-	bufferString = newString;
-	if( !isEndOfLine(bufferString.charAt( bufferString.length()-1 ) ) ) bufferString += endOfLineCharacter;//append an end of line character if none there
+	if(!loadBuffer(newString)){
+		commandState.bit.commandHandled = false;
+		return false;
+	}
 	bool prompt = commandPrompt();
 	commandPrompt(OFF);
 	commandState.bit.commandHandled = !handleCommand();
@@ -227,21 +758,105 @@ bool Commander::feedString(String newString){
 Commander& Commander::loadString(String newString){
 	//Load a string to commander for processing the next time update() is called
 	if(newString.length() < 2) return *this; //return if string is not valid - too short for a command and endofline
-	bufferString = newString;
-	if( !isEndOfLine(bufferString.charAt( bufferString.length()-1 ) ) ) bufferString += endOfLineCharacter;//append an end of line character if none there
-	commandState.bit.isCommandPending = true; 
+	if(loadBuffer(newString)) commandState.bit.isCommandPending = true; 
 	return *this;
 }
 //==============================================================================================================
+bool Commander::loadBuffer(const String& newString){
+	//copy a string and an end of line into the buffer for feedString() and loadString()
+	//like an overlong line from the port, a string that doesn't fit is dropped rather than handled part way through
+	bufferString = newString;
+	chainEnd = 0;
+	commandState.bit.stringOverflow = (bufferString.length() < newString.length() || !terminateBuffer());
+	if(!commandState.bit.stringOverflow) return true;
+	bufferString.clear();
+	if(ports.settings.bit.errorMessagesEnabled) println("#ERR: Buffer Overflow");
+	return false;
+}
+//==============================================================================================================
+bool Commander::terminateBuffer(){
+	//make sure the buffer ends with an end of line character. If it is full, the last char is replaced and this returns false
+	if( isEndOfLine(bufferString.charAt( bufferString.length()-1 ) ) ) return true;
+	if( bufferString.concat(endOfLineCharacter) ) return true;
+	bufferString.setCharAt(bufferString.length()-1, endOfLineCharacter);
+	return false;
+}
+//==============================================================================================================
 
 
 bool Commander::endLine(){
 	//add a newline to the buffer and process it - used for reading the last line of a file 
 	bufferString+= endOfLineCharacter;
+	terminateBuffer();
 	commandState.bit.commandHandled = !handleCommand();
 	return commandState.bit.commandHandled;
 }
 //==============================================================================================================
+scriptResult_t Commander::runScript(Stream &source, bool stopOnError, uint16_t idleTimeout){
+	//Read source in blocks and handle every line in it, including a last line with no end of line.
+	//The prompt and echo are turned off while the script runs. Anything already in the buffer is discarded
+	//The script ends when source has nothing available. That suits a File or a buffer in memory where the whole script is there from the start.
+	//For a source where data arrives over time (a serial port or network client) set idleTimeout to the milliseconds to wait for more data
+	scriptResult_t result;
+	uint32_t startTime = millis();
+	uint32_t lastData = startTime;
+	bool prompt = ports.settings.bit.commandPromptEnabled;
+	bool echoTerm = ports.settings.bit.echoTerminal;
+	bool echoAlt = ports.settings.bit.echoToAlt;
+	ports.settings.bit.commandPromptEnabled = false;
+	ports.settings.bit.echoTerminal = false;
+	ports.settings.bit.echoToAlt = false;
+	resetBuffer();
+	uint8_t block[DEFAULT_READ_BLOCK];
+	bool running = true;
+	while(running){
+		int avail = source.available();
+		if(avail <= 0){
+			if(millis() - lastData >= idleTimeout) break;
+			yield();
+			continue;
+		}
+		if(avail > (int)sizeof(block)) avail = sizeof(block);
+		size_t length = source.readBytes(block, avail); //only ask for what is available so this never waits for the timeout
+		if(length == 0) break;
+		lastData = millis();
+		for(size_t n = 0; n < length && running; n++){
+			if(processBuffer(block[n])) running = runScriptLine(result, stopOnError);
+		}
+	}
+	//handle the last line if it had no end of line
+	if(running && commandState.bit.bufferState == BUFFER_BUFFERING_PACKET && bufferString.length() > 0){
+		terminateBuffer();
+		runScriptLine(result, stopOnError);
+	}
+	resetBuffer();
+	ports.settings.bit.commandPromptEnabled = prompt;
+	ports.settings.bit.echoTerminal = echoTerm;
+	ports.settings.bit.echoToAlt = echoAlt;
+	result.time = millis() - startTime;
+	return result;
+}
+//==============================================================================================================
+bool Commander::runScriptLine(scriptResult_t &result, bool stopOnError){
+	//handle a line from a script and any commands chained to it. Returns false if the script should stop
+	commandState.bit.unknownCommand = false;
+	bool failed = handleCommand();
+	while(commandState.bit.isCommandPending){
+		commandState.bit.isCommandPending = false;
+		failed |= handleCommand();
+	}
+	result.lines++;
+	if(failed || commandState.bit.unknownCommand){
+		result.errors++;
+		if(result.firstError == 0) result.firstError = result.lines;
+		if(stopOnError){
+			result.stopped = true;
+			return false;
+		}
+	}
+	return true;
+}
+//==============================================================================================================
 
 
 Commander& Commander::transfer(Commander& Cmdr){
@@ -257,11 +872,23 @@ Commander& Commander::transfer(Commander& Cmdr){
 bool Commander::transferTo(const commandList_t *commands, uint32_t size, String newName){
 	//Transfer command to the new command array
 	attachCommands(commands, size);
+	return transferPayload(newName);
+}
+//==============================================================================================================
+bool Commander::transferTo(CommandTable& commands, String newName){
+	//Transfer command to a precomputed table - only the table pointer changes
+	attachCommands(commands);
+	return transferPayload(newName);
+}
+//==============================================================================================================
+bool Commander::transferPayload(String& newName){
+	//finish a transfer - if there was a payload handle it as a command in the new layer
 	commanderName = newName;
 	if( hasPayload() ){
     //Serial.println("handing payload to get command list");
 		//bufferString = bufferString.substring(Cmdr.endIndexOfLastCommand+1);
 		bufferString.remove(0, endIndexOfLastCommand+1);
+		if(chainEnd) chainEnd -= endIndexOfLastCommand+1;
 		//Serial.print(bufferString);
 		//keep this command prompt disabled if it wasn't already
 		commandPrompt(OFF); //dsiable the prompt so it doesn't print twice
@@ -280,43 +907,64 @@ Commander& Commander::transferBack(const commandList_t *commands, uint32_t size,
 	return *this;
 }
 //==============================================================================================================
+Commander& Commander::transferBack(CommandTable& commands, String newName){
+	//Transfer command to a precomputed table
+	attachCommands(commands);
+	commanderName = newName;
+	return *this;
+}
+//==============================================================================================================
 Commander&  Commander::setBuffer(uint16_t buffSize){
 	bufferSize = buffSize;
-	bufferString.reserve(bufferSize);
+	bufferString.setCapacity(bufferSize);
 	return *this;
 }
 //==============================================================================================================
 Commander& Commander::attachCommands(const commandList_t *commands, uint32_t size){
-	commandList = commands;
-	//numOfCmds = sizeof(myCommands) /  sizeof(myCommands[0]); //calculate the number of commands so we know the array bounds
-	commandListEntries = (uint16_t)(size / sizeof(commandList_t)); //size is the size of the whole array, not the individual entries
-	computeLengths();
+	//use this objects own table for the list
+	if(!useOwnTable()) return *this;
+	ownTable->attach(commands, size);
+	commandsChanged();
 	return *this;
 }
-
+//==============================================================================================================
 Commander&  	Commander::attachCommandArray(const commandList_t *commands, uint32_t length){
-	commandList = commands;
-	//numOfCmds = sizeof(myCommands) /  sizeof(myCommands[0]); //calculate the number of commands so we know the array bounds
-	commandListEntries = length;
-	computeLengths();
+	if(!useOwnTable()) return *this;
+	ownTable->attachArray(commands, length);
+	commandsChanged();
+	return *this;
+}
+//==============================================================================================================
+bool Commander::useOwnTable(){
+	//switch to this objects own table, it is allocated the first time a command list is attached directly
+	if(ownTable == NULL) ownTable = new CommandTable;
+	if(ownTable == NULL) return false;
+	table = ownTable;
+	return true;
+}
+//==============================================================================================================
+Commander& Commander::attachCommands(CommandTable& commands){
+	//share a table that has already been computed - nothing is copied or allocated
+	table = &commands;
+	commandsChanged();
 	return *this;
 }
 //==============================================================================================================
 Commander& Commander::quickSetHelp(){
-	if( bufferString.indexOf("help") > -1 )	commandState.bit.quickHelp = true;
-	else commandState.bit.quickHelp = false;
+	commandState.bit.quickHelp = (findKey("help", 4) > -1);
 	return *this;
 }
 //==============================================================================================================
-int Commander::quick(String cmd){
-	//look for the string, if found return true
+int Commander::quick(const char* cmd){
+	//look for the string, if found return the index of the end of it in the buffer, otherwise 0
 	//print help if help was triggered
 	if(qSetHelp(cmd)) return 0;
-	return qSetSearch(cmd);
+	int sRes = qSetSearch(cmd);
+	return sRes < 0 ? 0 : sRes;
 }
 
 //==============================================================================================================
-bool Commander::quickSet(String cmd, int& var){
+bool Commander::quickSet(const char* cmd, int& var){
 	//look for the string, if found try and parse an int
 	//print help if help was triggered
 	if(qSetHelp(cmd)) return 0;
@@ -334,8 +982,8 @@ bool Commander::quickSet(String cmd, int& var){
 	return false;
 }
 //==============================================================================================================
-bool Commander::quickSet(String cmd, float& var){
-	//look for the string, if found try and parse an int
+bool Commander::quickSet(const char* cmd, float& var){
+	//look for the string, if found try and parse a float
 	//print help if help was triggered
 	if(qSetHelp(cmd)) return 0;
 	int sRes = qSetSearch(cmd);
@@ -352,8 +1000,8 @@ bool Commander::quickSet(String cmd, float& var){
 	return false;
 }
 //==============================================================================================================
-bool Commander::quickSet(String cmd, double& var){
-	//look for the string, if found try and parse an int
+bool Commander::quickSet(const char* cmd, double& var){
+	//look for the string, if found try and parse a double
 	//print help if help was triggered
 	if(qSetHelp(cmd)) return 0;
 	int sRes = qSetSearch(cmd);
@@ -370,8 +1018,8 @@ bool Commander::quickSet(String cmd, double& var){
 	return false;
 }
 //==============================================================================================================
-bool Commander::quickSet(String cmd, String& str){
-	//look for the string, if found try and parse an int
+bool Commander::quickSet(const char* cmd, String& str){
+	//look for the string, if found try and get the next string
 	//print help if help was triggered
 	if(qSetHelp(cmd)) return 0;
 	int sRes = qSetSearch(cmd);
@@ -388,17 +1036,53 @@ bool Commander::quickSet(String cmd, String& str){
 	return false;
 }
 //==============================================================================================================
-int Commander::qSetSearch(String &cmd){
-	int idx = bufferString.indexOf(cmd);
-	if(idx < 0) return false;
-	//idx += cmd.length();
-	return idx + cmd.length();
-	//if(cmd.length() == 1) idx++;
-	//else 								idx = bufferString.indexOf(" ", idx+1); //find the next space
-	//return idx;
+int Commander::qSetSearch(const char* cmd){
+	//returns the index in the buffer of the end of the key, or -1 if it isn't in the payload
+	return findKey(cmd, strlen(cmd));
+}
+//==============================================================================================================
+int Commander::findKey(const char* key, uint16_t keyLength){
+	//Find a payload item that exactly matches key and return the index in the buffer where it ends, or -1.
+	//Keys are compared against the item table, which was built once when the command was matched, so the line isn't searched again
+	//and a key can't match part of another item (x doesn't match max). A key can contain delimiters, EG "motor speed".
+	if(keyLength == 0) return -1;
+	if(commandState.bit.itemsValid){
+		for(uint8_t n = 0; n < itemCount; n++){
+			if(keyMatches(items[n].start, key, keyLength)) return items[n].start + keyLength;
+		}
+		if(!commandState.bit.itemsOverflow) return -1;
+	}else if(!hasPayload()) return -1;
+	//search any items that didn't fit in the table
+	uint16_t tmp = dataReadIndex;
+	int found = -1;
+	if(commandState.bit.itemsValid && itemCount > 0){
+		dataReadIndex = items[itemCount-1].start;
+		if(!findNextItem()) dataReadIndex = 0;
+	}else{
+		dataReadIndex = endIndexOfLastCommand;
+		if(!findNextItem()) dataReadIndex = 0;
+	}
+	while(dataReadIndex > 0){
+		if(keyMatches(dataReadIndex, key, keyLength)){
+			found = dataReadIndex + keyLength;
+			break;
+		}
+		if(!findNextItem()) break;
+	}
+	dataReadIndex = tmp;
+	return found;
 }
 //==============================================================================================================
-bool Commander::qSetHelp(String &cmd){
+bool Commander::keyMatches(uint16_t start, const char* key, uint16_t keyLength){
+	//true if key is at start in the buffer and is followed by a delimiter or the end of the line
+	if(start + keyLength > bufferString.length()) return false;
+	const char* buf = bufferString.c_str() + start;
+	if(memcmp(buf, key, keyLength) != 0) return false;
+	char next = buf[keyLength];
+	return next == '\0' || next == '\r' || isEndOfCommand(next);
+}
+//==============================================================================================================
+bool Commander::qSetHelp(const char* cmd){
 	//Quicksets and gets cannot be chained so flag this so chaining will halt
 	commandState.bit.quickSetCalled = true;
 	if(commandState.bit.quickHelp){
@@ -409,80 +1093,162 @@ bool Commander::qSetHelp(String &cmd){
 	return 0;
 }
 //==============================================================================================================
-Commander&  Commander::quickGet(String cmd, int var){
-	//look for the string, if found try and parse an int
-	//print help if help was triggered
+bool Commander::qGetSearch(const char* cmd){
+	//returns true if the key is in the payload and its value should be printed
 	findNextItem();
 	if(commandState.bit.quickHelp){
 		print("\t");
 		println(cmd);
-		return *this;
-	}
-	if(bufferString.indexOf(cmd) > -1){
-		print(cmd);
-		print("=");
-		println(var);
+		return false;
 	}
-	return *this;
+	if(qSetSearch(cmd) < 0) return false;
+	print(cmd);
+	print("=");
+	return true;
 }
 //==============================================================================================================
-Commander&  Commander::quickGet(String cmd, float var){
-	//look for the string, if found try and parse an int
+Commander&  Commander::quickGet(const char* cmd, int var){
+	//look for the string, if found print it with the value
 	//print help if help was triggered
-	findNextItem();
-	if(commandState.bit.quickHelp){
-		print("\t");
-		println(cmd);
-		return *this;
-	}
-	if(bufferString.indexOf(cmd) > -1){
-		print(cmd);
-		print("=");
-		println(var);
-	}
+	if(qGetSearch(cmd)) printNumber(var).println();
 	return *this;
 }
 //==============================================================================================================
-Commander&  Commander::quickGet(String cmd, String str){
-	//look for the string, if found try and parse an int
-	//print help if help was triggered
-	findNextItem();
-	if(commandState.bit.quickHelp){
-		print("\t");
-		println(cmd);
-		return *this;
-	}
-	if(bufferString.indexOf(cmd) > -1){
-		print(cmd);
-		print("=");
-		println(str);
-	}
+Commander&  Commander::quickGet(const char* cmd, float var){
+	if(qGetSearch(cmd)) printNumber(var, 2).println();
 	return *this;
 }
 //==============================================================================================================
-bool Commander::getFloat(float &myFloat){
+Commander&  Commander::quickGet(const char* cmd, double var){
+	if(qGetSearch(cmd)) printNumber(var, 2).println();
+	return *this;
+}
+//==============================================================================================================
+Commander&  Commander::quickGet(const char* cmd, const String& str){
+	if(qGetSearch(cmd)) println(str);
+	return *this;
+}
+//==============================================================================================================
+bool Commander::getInteger(int64_t &myInt){
 	if(tryGet()){
 		//Parse it to the variable
-		String subStr = bufferString.substring(dataReadIndex);
-		myFloat = subStr.toFloat();
-		if(!findNextItem()) dataReadIndex = 0; 
-		return true; //nextSpace();
-
-	}else return 0;
+		uint8_t status = PARSE_OK;
+		const char* end = parseInteger(bufferString.c_str() + dataReadIndex, myInt, status, parseOptions());
+		numberParsed(end, status);
+		//if there is no space next, set dataReadIndex to zero and return true - you parsed an int, but next time it will fail.
+		if(!nextItem()) dataReadIndex = 0;
+		return true;
+	}
+	parseStatus = PARSE_NO_NUMBER;
+	return 0;
+}
+//==============================================================================================================
+bool Commander::getFloat(float &myFloat){
+	double value = 0;
+	if(!getDouble(value)) return 0;
+	myFloat = (float)value;
+	if(myFloat - myFloat != 0 && parseStatus == PARSE_OK) parseStatus = PARSE_OVERFLOW; //too big for a float
+	return true;
 }
 //==============================================================================================================
 bool Commander::getDouble(double &myDouble){
 	if(tryGet()){
 		//Parse it to the variable
-		String subStr = bufferString.substring(dataReadIndex);
-		myDouble = subStr.toFloat(); //todouble not supported on some distributions
-		if(!findNextItem()) dataReadIndex = 0; 
+		uint8_t status = PARSE_OK;
+		const char* end = parseDouble(bufferString.c_str() + dataReadIndex, myDouble, status, parseOptions());
+		numberParsed(end, status);
+		if(!nextItem()) dataReadIndex = 0; 
 		return true; //nextSpace();
-	}else return 0;
+	}
+	parseStatus = PARSE_NO_NUMBER;
+	return 0;
+}
+//==============================================================================================================
+bool Commander::getFixed(int32_t &myFixed, uint8_t decimals){
+	if(tryGet()){
+		//Parse it to the variable
+		uint8_t status = PARSE_OK;
+		const char* end = parseFixed(bufferString.c_str() + dataReadIndex, myFixed, decimals, status, parseOptions());
+		numberParsed(end, status);
+		if(!nextItem()) dataReadIndex = 0; 
+		return true;
+	}
+	parseStatus = PARSE_NO_NUMBER;
+	return 0;
+}
+//==============================================================================================================
+void Commander::numberParsed(const char* end, uint8_t status){
+	//record where a number ended, and flag it if the item carries on after the number
+	parseEndIndex = end - bufferString.c_str();
+	parseStatus = status;
+	if(status == PARSE_OK && *end != '\0' && *end != '\r' && !isEndOfCommand(*end)) parseStatus = PARSE_TRAILING;
+}
+//==============================================================================================================
+uint16_t Commander::getFloats(float *values, uint16_t maxValues, int16_t *badItem){
+	uint16_t count = 0;
+	while(count < maxValues){
+		const char* start = numberStart(badItem);
+		if(start == NULL) break;
+		double value = 0;
+		uint8_t status = PARSE_OK;
+		const char* end = parseDouble(start, value, status, parseOptions());
+		float item = (float)value;
+		if(item - item != 0 && status == PARSE_OK) status = PARSE_OVERFLOW; //too big for a float
+		if(!numberDone(end, status, badItem)) break;
+		values[count++] = item;
+	}
+	return count;
+}
+//==============================================================================================================
+uint16_t Commander::getDoubles(double *values, uint16_t maxValues, int16_t *badItem){
+	uint16_t count = 0;
+	while(count < maxValues){
+		const char* start = numberStart(badItem);
+		if(start == NULL) break;
+		double item = 0;
+		uint8_t status = PARSE_OK;
+		const char* end = parseDouble(start, item, status, parseOptions());
+		if(!numberDone(end, status, badItem)) break;
+		values[count++] = item;
+	}
+	return count;
+}
+//==============================================================================================================
+const char* Commander::numberStart(int16_t *badItem){
+	//Returns a pointer to the number at dataReadIndex for the array getters, or NULL if there isn't one
+	//badItem is set to the buffer index of an item that is not a number, or -1 at the end of the payload
+	if(badItem) *badItem = -1;
+	if(tryGet()) return bufferString.c_str() + dataReadIndex;
+	if(dataReadIndex >= endIndexOfLastCommand && isItem(bufferString.charAt(dataReadIndex))){
+		parseStatus = PARSE_NO_NUMBER;
+		if(badItem) *badItem = dataReadIndex;
+	}else parseStatus = PARSE_OK; //reached the end of the payload
+	return NULL;
+}
+//==============================================================================================================
+bool Commander::numberDone(const char* end, uint8_t status, int16_t *badItem){
+	//Finish a number for the array getters. A bad number stays at dataReadIndex so it can be read as a String instead
+	numberParsed(end, status);
+	if(parseStatus != PARSE_OK){
+		if(badItem) *badItem = dataReadIndex;
+		return false;
+	}
+	if(!nextItem()) dataReadIndex = 0;
+	return true;
 }
 //==============================================================================================================
 bool Commander::getString(String &myString){
 	if(!hasPayload() || dataReadIndex < endIndexOfLastCommand) return 0;
+	if(syncItem()){
+		//use the item table
+		uint16_t start = items[itemIndex].start;
+		uint16_t end = start + items[itemIndex].length;
+		if(!items[itemIndex].quoted) 						copyItem(myString, start, end);
+		else if(bufferString.charAt(end-1) == '"') copyItem(myString, start+1, end-1);
+		else 																		copyItem(myString, start+1, end);
+		if(!nextItem()) dataReadIndex = 0;
+		return 1;
+	}
 	int start = 0;
 	//New method:
 	//println("get String:");
@@ -490,13 +1256,13 @@ bool Commander::getString(String &myString){
 	start = dataReadIndex;
 	if(bufferString.charAt(dataReadIndex) == '"'){
 		findNextDelim();
-		if(bufferString.charAt(dataReadIndex-1) == '"') myString = bufferString.substring(start+1, dataReadIndex-1);
-		else myString = bufferString.substring(start+1, dataReadIndex);
+		if(bufferString.charAt(dataReadIndex-1) == '"') copyItem(myString, start+1, dataReadIndex-1);
+		else copyItem(myString, start+1, dataReadIndex);
 		if(!findNextItem()) dataReadIndex = 0;
 		return 1;
 	}
 	findNextDelim();
-	myString = bufferString.substring(start, dataReadIndex);
+	copyItem(myString, start, dataReadIndex);
 	
 	//print("Start=");
 	//println(start);
@@ -507,11 +1273,34 @@ bool Commander::getString(String &myString){
 	return 1;
 }
 //==============================================================================================================
+void Commander::copyItem(String &myString, uint16_t start, uint16_t end){
+	//copy part of the buffer to a String without creating a temporary substring
+	if(start > end){
+		uint16_t tmp = start;
+		start = end;
+		end = tmp;
+	}
+	if(end > bufferString.length()) end = bufferString.length();
+	if(start >= end){
+		myString = "";
+		return;
+	}
+	char endChar = bufferString.charAt(end);
+	bufferString.setCharAt(end, '\0');
+	myString = bufferString.c_str() + start;
+	bufferString.setCharAt(end, endChar);
+}
+//==============================================================================================================
 uint8_t Commander::countItems(){
 	//Returns the number of items in the payload. Items are any substrings with a space, delimChar or endOfLineCharacter at each end.
 	uint8_t items = 0;
 	//bool state = 0;
 	if(!hasPayload()) return items; //has payload returns true if an item was found after the command
+	if(syncItem() && !commandState.bit.itemsOverflow){
+		items = itemCount - itemIndex;
+		rewind();
+		return items;
+	}
 	items++;
 	while(findNextItem()) items++;
 	rewind();
@@ -519,19 +1308,28 @@ uint8_t Commander::countItems(){
 }
 //==============================================================================================================
 String 		Commander::getCommandItem(uint16_t commandItem){
-	if(commandItem >= commandListEntries ) return "";
+	if(commandItem >= table->commandListEntries ) return "";
 	String line = "\t";
-	line.concat(commandList[commandItem].commandString);
-	line.concat(getWhiteSpace(longestCommand - commandLengths[commandItem]));
+	line.concat(table->commandList[commandItem].commandString);
+	line.concat(getWhiteSpace(table->longestCommand - table->commandLengths[commandItem]));
 	line.concat("| ");
-	line.concat(commandList[commandItem].manualString);
+	line.concat(table->commandList[commandItem].manualString);
 	return line;
 }
 //==============================================================================================================
 String Commander::getInternalCommandItem(uint8_t internalItem){
 	if(internalItem >= INTERNAL_COMMAND_ITEMS ) return "";
 	String line = "\t";
-	if(internalItem > 3){
+	if(internalItem >= INTERNAL_VARIABLE_COMMANDS){
+		line.concat(internalCommandArray[internalItem]);
+		if(internalItem == 8) line.concat(" (names)");
+		if(internalItem == 9) line.concat(" (name value ...)");
+		if(internalItem == 11) line.concat(" (names period_ms [change])");
+		if(internalItem == 12) line.concat(" (names)");
+	}else if(internalItem == 7){
+		line.concat(internalCommandArray[internalItem]);
+		line.concat(" (on/off/reset)");
+	}else if(internalItem > 3){
 		line.concat(internalCommandArray[internalItem]);
 		line.concat(" (on/off)");
 	}else line.concat(internalCommandArray[internalItem]);
@@ -547,7 +1345,7 @@ Commander& Commander::printCommandPrompt(){
 //==============================================================================================================
 bool Commander::containsTrue(){
 	//Search for true TRUE or True
-	for(uint8_t n = dataReadIndex; n < bufferString.length()-4; n++){
+	for(uint16_t n = dataReadIndex; n < bufferString.length()-4; n++){
 		//is is a T or a t
 		if(bufferString.charAt(n) == 't' || bufferString.charAt(n) == 'T'){
 			//is the preceeding char a delimiter, and does the string end with a delimiter or a newline
@@ -567,7 +1365,7 @@ bool Commander::containsTrue(){
 }
 //==============================================================================================================
 bool Commander::containsFalse(){
-		for(uint8_t n = dataReadIndex; n < bufferString.length()-5; n++){
+		for(uint16_t n = dataReadIndex; n < bufferString.length()-5; n++){
 		//is is a T or a t
 		if(bufferString.charAt(n) == 'f' || bufferString.charAt(n) == 'F'){
 			//is the preceeding char a delimiter and does it end with a delim or newline
@@ -590,7 +1388,7 @@ bool Commander::containsFalse(){
 }
 //==============================================================================================================
 bool Commander::containsOn(){
-	for(uint8_t n = dataReadIndex; n < bufferString.length()-2; n++){
+	for(uint16_t n = dataReadIndex; n < bufferString.length()-2; n++){
 		//is is a o or a O
 		if(bufferString.charAt(n) == 'o' || bufferString.charAt(n) == 'O'){
 			//is the preceeding char a delimiter, and does the string end with a delimiter or a newline
@@ -604,7 +1402,7 @@ bool Commander::containsOn(){
 }
 //==============================================================================================================
 bool Commander::containsOff(){
-	for(uint8_t n = dataReadIndex; n < bufferString.length()-3; n++){
+	for(uint16_t n = dataReadIndex; n < bufferString.length()-3; n++){
 		//is is a o or a O
 		if(bufferString.charAt(n) == 'o' || bufferString.charAt(n) == 'O'){
 			//is the preceeding char a delimiter, and does the string end with a delimiter or a newline
@@ -626,26 +1424,47 @@ Commander&  Commander::endOfLineChar(char eol){
 	return *this;
 }
 //==============================================================================================================
-void Commander::computeLengths(){
-	//compute the length of each command
-	if(commandListEntries == 0) return;
-	//delete the current array of not NULL
-	if(commandLengths) delete [] commandLengths;
-	commandLengths = new uint8_t[commandListEntries];
-	for(int n = 0; n < commandListEntries; n++){
-		commandLengths[n] = getLength(n);
-		if(commandLengths[n] > longestCommand) longestCommand = commandLengths[n];
+void Commander::commandsChanged(){
+	//the command table is new or has been recomputed
+	commandState.bit.matchTracking = false;
+	//switch to the stats for the new list - the stats for the old one are kept
+	if(ports.settings.bit.commandStats) selectStats();
+}
+//==============================================================================================================
+void Commander::startTracking(){
+	//start matching a new line against the sorted command index as it is written to the buffer
+	matchLo = 0;
+	matchHi = table->commandListEntries;
+	matchPos = 0;
+	matchIndex = -1;
+	commandState.bit.matchTracking = (table->commandListEntries > 0);
+}
+//==============================================================================================================
+void Commander::trackCommand(char dataByte){
+	//Walk the sorted command index like a trie, one byte at a time.
+	//matchLo to matchHi is the range of commands that start with every byte written so far.
+	//Commands that are a prefix of others sort first, so when an end of command char arrives
+	//the first entry in the range is a complete match if its length is the number of bytes so far.
+	uint16_t pos = matchPos++;
+	if(matchLo >= matchHi) return; //nothing left to match
+	if(pos > 0 && isEndOfCommand(dataByte) && table->commandLengths[table->commandOrder[matchLo]] == pos) matchIndex = table->commandOrder[matchLo];
+	//drop commands that are too short to continue
+	while(matchLo < matchHi && table->commandLengths[table->commandOrder[matchLo]] <= pos) matchLo++;
+	//the remaining commands with dataByte at this position are contiguous - find where they start and end
+	uint8_t lo = matchLo, hi = matchHi;
+	while(lo < hi){
+		uint8_t mid = lo + (hi - lo) / 2;
+		if((uint8_t)table->commandList[table->commandOrder[mid]].commandString[pos] < (uint8_t)dataByte) lo = mid + 1;
+		else hi = mid;
 	}
-}
-//==============================================================================================================
-uint8_t Commander::getLength(uint8_t indx){
-	uint8_t length = 0;
-	for(uint8_t n = 0; n < 128; n++){
-		if(commandList[indx].commandString[n] != '\0') length++;
-		else return length;
+	matchLo = lo;
+	hi = matchHi;
+	while(lo < hi){
+		uint8_t mid = lo + (hi - lo) / 2;
+		if((uint8_t)table->commandList[table->commandOrder[mid]].commandString[pos] <= (uint8_t)dataByte) lo = mid + 1;
+		else hi = mid;
 	}
-	//Should this return zero if max length is reached ...?
-	return length;
+	matchHi = lo;
 }
 //==============================================================================================================
 bool Commander::handleCommand(){
@@ -653,6 +1472,9 @@ bool Commander::handleCommand(){
 	//ignore any stray end of line characters
 	//This is handled when processing the buffer
 	//if(bufferString.length() == 1 && bufferString.charAt(0) == endOfLineCharacter) return 0;
+	commandCount++;
+	if(commandState.bit.frameReceiving) return handleFrame();
+	if(separatorCharacter && chainEnd == 0) splitChain();
 	if(ports.settings.bit.locked && ports.settings.bit.useHardLock){
 		//if the command string starts with unlock then handle unlocking
 		tryUnlock();
@@ -669,10 +1491,12 @@ bool Commander::handleCommand(){
 	
 	//Match command will handle internal commands 
 	//commandType = matchCommand();
+	commandState.bit.itemsValid = false;
 	commandState.bit.commandType =  matchCommand();
   bool returnVal = false;
 	switch(commandState.bit.commandType){
 	case INTERNAL_COMMAND:
+		splitItems();
 		returnVal = handleInternalCommand(commandIndex);
 			
 		//Comment or internal comnand, nothing to see here, move along.
@@ -683,6 +1507,17 @@ bool Commander::handleCommand(){
 			returnVal = handleCustomCommand();
 			if(returnVal == 1) returnVal = handleUnknown();
 		break;
+	case OPCODE_COMMAND:
+		if(ports.settings.bit.locked == true){
+			println();
+			break;
+		}
+		//dataReadIndex was set to the end of the opcode by matchOpcode()
+		endIndexOfLastCommand = dataReadIndex;
+		if(!findNextItem()) dataReadIndex = 0;
+		splitItems();
+		returnVal = opcodeTable->list()[commandIndex].handler(*this);
+		break;
 	case COMMENT_COMMAND:
 		handleComment();
 		//returnVal = 0; //do nothing - comment lines are ignored
@@ -698,11 +1533,12 @@ bool Commander::handleCommand(){
 		}
 		//anything > -1 should be a command
 		//user command
-		endIndexOfLastCommand = commandLengths[commandIndex];
+		endIndexOfLastCommand = table->commandLengths[commandIndex];
 		dataReadIndex = endIndexOfLastCommand;
 		if(!findNextItem()) dataReadIndex = 0;
+		splitItems();
 		//call the appropriate function from the function list and return the result
-		if(commandIndex < commandListEntries){
+		if(commandIndex < table->commandListEntries){
 			#if defined BENCHMARKING_ON
 				benchmarkStartTime4 = micros();
 			#endif
@@ -710,7 +1546,7 @@ bool Commander::handleCommand(){
 					//look through the extra help string array and print it out
 					if(extraHelp != NULL) println(extraHelp[commandIndex]);
 					commandState.bit.quickHelp = false;
-			}else	returnVal = commandList[commandIndex].handler(*this);
+			}else returnVal = callHandler(commandIndex);
 			#if defined BENCHMARKING_ON
 				benchmarkTime4 = micros() - benchmarkStartTime4;
 			#endif
@@ -725,24 +1561,152 @@ bool Commander::handleCommand(){
 	printCommandPrompt();
 	commandState.bit.chaining = false;
 	//return here if this is a comment - comments break chains
-	if(commandState.bit.commandType == COMMENT_COMMAND || commandState.bit.quickSetCalled ){
+	flushOutput();
+	if(commandState.bit.commandType == COMMENT_COMMAND){
+		chainEnd = 0; //a comment takes up the rest of the line
+		return returnVal;
+	}
+	if(commandState.bit.quickSetCalled){
 		commandState.bit.quickSetCalled = false;
+		if(chainEnd) nextChainSegment();
 		return returnVal;
 	}
 	
+	bool chained = false;
 	if(commandState.bit.chain || ports.settings.bit.autoChain){
 		//startOfNextItem();
 		if(dataReadIndex > 0){
 			//if(ports.settings.bit.commandPromptEnabled) println();
-			loadString(bufferString.substring(dataReadIndex) );
+			//drop the command that was just handled - this only moves the start of the buffer, nothing is copied
+			bufferString.remove(0, dataReadIndex);
+			if(chainEnd) chainEnd -= dataReadIndex;
+			if(bufferString.length() > 1){
+				commandState.bit.isCommandPending = true;
+				commandState.bit.chainPending = true;
+			}
 			commandState.bit.chaining = true;
+			chained = true;
 		}
 		commandState.bit.chain = false;
 	}
+	//move on to the command after the separator once this part of the line is finished
+	if(!chained && chainEnd) nextChainSegment();
   return returnVal;
 }
 //==============================================================================================================
+void Commander::splitChain(){
+	//Replace the first separator that isn't in quotes with an end of line, so the command only sees its own part of the line
+	const char* buf = bufferString.c_str();
+	if(buf[0] == commentCharacter) return; //comments are not split
+	bool quoted = false;
+	for(uint16_t n = 0; n < bufferString.length(); n++){
+		char ch = buf[n];
+		if(isEndOfLine(ch)) return;
+		if(ch == '"' && !ports.settings.bit.ignoreQuotes) quoted = !quoted;
+		else if(ch == separatorCharacter && !quoted){
+			bufferString.setCharAt(n, endOfLineCharacter);
+			chainEnd = n + 1;
+			commandState.bit.matchTracking = false; //the command was tracked against the whole line
+			return;
+		}
+	}
+}
+//==============================================================================================================
+void Commander::nextChainSegment(){
+	//drop the part of the line that has been handled, and any spaces or separators before the next command
+	uint16_t skip = chainEnd;
+	chainEnd = 0;
+	const char* buf = bufferString.c_str();
+	while(skip < bufferString.length() && !isEndOfLine(buf[skip]) && (isDelimiter(buf[skip]) || buf[skip] == separatorCharacter)) skip++;
+	bufferString.remove(0, skip);
+	if(bufferString.length() > 1){
+		commandState.bit.isCommandPending = true;
+		commandState.bit.chainPending = true;
+	}
+	//errors are not suppressed for commands after a separator
+	commandState.bit.chaining = false;
+}
+//==============================================================================================================
+void Commander::handleChain(){
+	//handle the rest of a chained line straight away, instead of one command per update
+	//commands loaded with loadString() are still left for the next update
+	while(commandState.bit.isCommandPending && commandState.bit.chainPending){
+		commandState.bit.chainPending = false;
+		processPending();
+	}
+	commandState.bit.chainPending = false;
+}
+//==============================================================================================================
+bool Commander::handleFrame(){
+	//A complete binary frame is in the buffer without its start byte: [length][command ID][arguments][CRC]
+	const uint8_t* frame = (const uint8_t*)bufferString.c_str();
+	uint8_t commandID = frame[1];
+	bool returnVal = false;
+	frameState_t &state = *frameState;
+	state.read = FRAME_HEADER_LENGTH - 1;
+	state.end = state.read + frame[0];
+	if(bytesWritten > bufferString.length()) frameError(FRAME_ERR_LENGTH, commandID);
+	else if(frameCRC(FRAME_CRC_INIT, frame, state.end) != (uint16_t)(frame[state.end] | (frame[state.end+1] << 8))) frameError(FRAME_ERR_CRC, commandID);
+	else if(ports.settings.bit.locked) frameError(FRAME_ERR_LOCKED, commandID);
+	else{
+		int idx = commandID;
+		if(commandID == FRAME_NAMED){
+			//the arguments start with the command string
+			const char* name = (const char*)&frame[state.read];
+			const char* nameEnd = (const char*)memchr(name, '\0', state.end - state.read);
+			idx = nameEnd ? table->find(name, nameEnd - name) : -1;
+			if(nameEnd) state.read += (nameEnd - name) + 1;
+		}
+		if(idx < 0 || idx >= table->commandListEntries) frameError(FRAME_ERR_UNKNOWN, commandID);
+		else{
+			commandIndex = idx;
+			commandState.bit.commandType = USER_COMMAND;
+			//there is no text payload - dataReadIndex is before the end of the command so the text getters find nothing
+			commandState.bit.itemsValid = false;
+			endIndexOfLastCommand = 1;
+			dataReadIndex = 0;
+			state.replyLength = 0;
+			commandState.bit.binaryFrame = true;
+			returnVal = callHandler(commandIndex);
+			commandState.bit.binaryFrame = false;
+			sendFrame(idx, state.reply, state.replyLength);
+		}
+	}
+	resetBuffer();
+	flushOutput();
+	return returnVal;
+}
+//==============================================================================================================
+bool Commander::frameByte(int dataByte){
+	//add a byte to the binary frame in the buffer, returns true when the frame is complete
+	//bytes that don't fit are counted but not stored, so an oversized frame is still read to the end
+	if(bytesWritten < bufferSize-1) bufferString += (char)dataByte;
+	bytesWritten++;
+	if(bytesWritten < FRAME_HEADER_LENGTH - 1 + FRAME_CRC_LENGTH) return false;
+	if(bytesWritten == (uint8_t)bufferString.charAt(0) + FRAME_HEADER_LENGTH - 1 + FRAME_CRC_LENGTH){
+		commandState.bit.newLine = true;
+		return true;
+	}
+	return false;
+}
+//==============================================================================================================
+void Commander::sendFrame(uint8_t commandID, const uint8_t* data, uint8_t length){
+	uint8_t header[FRAME_HEADER_LENGTH] = {FRAME_START, length, commandID};
+	uint16_t crc = frameCRC(FRAME_CRC_INIT, &header[1], FRAME_HEADER_LENGTH - 1);
+	crc = frameCRC(crc, data, length);
+	uint8_t crcBytes[FRAME_CRC_LENGTH] = {(uint8_t)crc, (uint8_t)(crc >> 8)};
+	sendOut(header, FRAME_HEADER_LENGTH);
+	if(length) sendOut(data, length);
+	sendOut(crcBytes, FRAME_CRC_LENGTH);
+}
+//==============================================================================================================
+void Commander::frameError(uint8_t code, uint8_t commandID){
+	uint8_t error[2] = {code, commandID};
+	sendFrame(FRAME_ERROR, error, 2);
+}
+//==============================================================================================================
 bool Commander::handleUnknown(){
+	commandState.bit.unknownCommand = true;
 	if(	commandState.bit.chaining && ports.settings.bit.autoChainSurpressErrors ){
 		if(ports.settings.bit.autoChain) findNextItem(); //move index to next delimiter so this item doesn't get chained again
 		//print("idx=");
@@ -754,7 +1718,8 @@ bool Commander::handleUnknown(){
 	
 	if(ports.settings.bit.errorMessagesEnabled){
 		print(F("#Command: \'"));
-		print(bufferString.substring(0, bufferString.length()-1));
+		int eol = bufferString.indexOf(endOfLineCharacter); //only print this command if there are more after a separator
+		write((const uint8_t*)bufferString.c_str(), eol < 0 ? bufferString.length() : eol);
 		println(F("\' not recognised"));
 	}
 	return 0;
@@ -799,20 +1764,31 @@ void Commander::handleComment(){
 //==============================================================================================================
 bool  Commander::processBuffer(int dataByte){
   if(dataByte == -1) return false; //no actual data to process
+	if(commandState.bit.frameReceiving) return frameByte(dataByte);
 	if(commandState.bit.bufferState == BUFFER_WAITING_FOR_START){
+		if(dataByte == FRAME_START && ports.settings.bit.binaryFrames){
+			//start of a binary frame
+			bufferString.clear();
+			bytesWritten = 0;
+			commandState.bit.frameReceiving = true;
+			frameState->startTime = millis();
+			return false;
+		}
 		//if you are waiting for the start of a line, and get an end of line character, or a CR character and these should be ignored, ignore it and return
 		if(isEndOfLine(dataByte) || (dataByte == '\r' && ports.settings.bit.stripCR) ) return false;
     if(dataByte == reloadCommandCharacter){
 			commandState.bit.newLine = true;
-			if(ports.settings.bit.echoTerminal) ports.outPort->print(bufferString); //print the old buffer
+			if(ports.settings.bit.echoTerminal) sendOut((const uint8_t*)bufferString.c_str(), bufferString.length()); //print the old buffer
 			//if(ports.inPort->peek() == ) ports.inPort->read();
 			//print("reloading: ");
-			ports.outPort->print(bufferString);
+			sendOut((const uint8_t*)bufferString.c_str(), bufferString.length());
 			return true;
 		}else {
 			//println("Start buffering");
 			commandState.bit.bufferState = BUFFER_BUFFERING_PACKET;
-			bufferString = "";//clear the buffer
+			bufferString.clear();//clear the buffer
+			chainEnd = 0;
+			startTracking();
 		}
 	}
 	//write('.');
@@ -829,7 +1805,10 @@ void Commander::writeToBuffer(int dataByte){
     return;
   }
   //if the character is not a cr, or if ignore cr is false, add it to the buffer
-  if(dataByte != '\r' || !ports.settings.bit.stripCR) bufferString += (char)dataByte;
+  if(dataByte != '\r' || !ports.settings.bit.stripCR){
+		if(commandState.bit.matchTracking) trackCommand((char)dataByte);
+		bufferString += (char)dataByte;
+	}
   if(dataByte == endOfLineCharacter) commandState.bit.newLine = true;
   bytesWritten++;
 }
@@ -842,6 +1821,8 @@ void Commander::resetBuffer(){
 	commandState.bit.prefixMessage = false;
 	commandState.bit.postfixMessage = false;
 	commandState.bit.newlinePrinted = true;
+	commandState.bit.matchTracking = false;
+	commandState.bit.frameReceiving = false;
 }
 //==============================================================================================================
 //return the index of the command, or handle the internal commands
@@ -860,35 +1841,41 @@ int Commander::matchCommand(){
 		#endif
 		return COMMENT_COMMAND;
 	}
-	//see if it starts with an int - if so then use the number function
+	//see if it starts with an int - if so then look it up in the opcode table or use the number function
 	if( isNumber(bufferString) ) {
+		bool opcodeFound = matchOpcode();
 		#if defined BENCHMARKING_ON
 			benchmarkTime3 = micros()-benchmarkStartTime3;
 			benchmarkTime2 = micros()-benchmarkStartTime2;
 		#endif
-		return CUSTOM_COMMAND;
+		return opcodeFound ? OPCODE_COMMAND : CUSTOM_COMMAND;
 	}
-	//Scan the command array for a match
+	//Search the sorted command index for a match
 	int indexOfLongest = -1;
-	uint8_t lastLength = 0;
 	#if defined BENCHMARKING_ON
 		benchmarkStartTime3 = micros();
 	#endif
-  for(uint8_t n = 0; n < commandListEntries; n++){
-		//if you get a match, check to see if the command is longer than the last stored length, if it is then update the last length and store the index
-		//When you get a match, make sure it is followed by a space or newline - otherwise a command like 'st' will be triggered by any string that starts with 'st'
-		if( commandLengths[n] > lastLength && checkCommand(n) ) {
-			lastLength = commandLengths[n];
-			indexOfLongest = (int)n;
+	if(commandState.bit.matchTracking && matchPos == bufferString.length()){
+		//the command was already matched as the line arrived
+		indexOfLongest = matchIndex;
+	}else{
+		//A command must be followed by a space, delimiter or newline - otherwise a command like 'st' would be triggered by any string that starts with 'st'
+		//so the only candidates are the parts of the buffer that end at one of those chars. Try the longest first so the longest matching command wins.
+		uint16_t maxLength = bufferString.length() > 0 ? bufferString.length()-1 : 0;
+		if(maxLength > table->longestCommand) maxLength = table->longestCommand;
+		for(int n = maxLength; n > 0 && indexOfLongest < 0; n--){
+			if( isEndOfCommand(bufferString.charAt(n)) ) indexOfLongest = table->find(bufferString.c_str(), n);
 		}
-  }
+	}
+	//the tracked match only applies to the line as it arrived - anything that reloads the buffer (chaining, feed, transfer) must search again
+	commandState.bit.matchTracking = false;
 	if(indexOfLongest > -1){
 		#if defined BENCHMARKING_ON
 			benchmarkTime3 = micros()-benchmarkStartTime3;
 			benchmarkTime2 = micros()-benchmarkStartTime2;
 		#endif
 		
-		dataReadIndex = commandLengths[indexOfLongest];
+		dataReadIndex = table->commandLengths[indexOfLongest];
 		commandIndex = indexOfLongest;
 		return USER_COMMAND;
 	}
@@ -925,18 +1912,18 @@ bool Commander::checkCommand(uint16_t cmdIdx){
 		benchmarkCounter++;
 	#endif
 	
-	if(bufferString.length() < (int16_t)commandLengths[cmdIdx]+1U) return false; //no match if the buffer is shorter than the command+1 (buffer will have the end of line char)
-	if(commandLengths[cmdIdx] == 1){
+	if(bufferString.length() < (int16_t)table->commandLengths[cmdIdx]+1U) return false; //no match if the buffer is shorter than the command+1 (buffer will have the end of line char)
+	if(table->commandLengths[cmdIdx] == 1){
 		//This command was a single char, if it is a match then return true if the next char in the buffer is an end of command char (newline, space or delim)
-		if(bufferString.charAt(0) != commandList[cmdIdx].commandString[0]) return false;
+		if(bufferString.charAt(0) != table->commandList[cmdIdx].commandString[0]) return false;
 		return isEndOfCommand(bufferString.charAt(1));
 	}
-	uint8_t y = commandLengths[cmdIdx]-1;
-	for(uint8_t x = 0; x < commandLengths[cmdIdx]; x++){
-		if(bufferString.charAt(y) != commandList[cmdIdx].commandString[y])return false;
-		if(bufferString.charAt(x) != commandList[cmdIdx].commandString[x])return false;
+	uint8_t y = table->commandLengths[cmdIdx]-1;
+	for(uint8_t x = 0; x < table->commandLengths[cmdIdx]; x++){
+		if(bufferString.charAt(y) != table->commandList[cmdIdx].commandString[y])return false;
+		if(bufferString.charAt(x) != table->commandList[cmdIdx].commandString[x])return false;
 		y--;
-		if(x==y || x+1 == y) return ((bufferString.charAt(y) == commandList[cmdIdx].commandString[y]) & isEndOfCommand( bufferString.charAt(commandLengths[cmdIdx]) ));
+		if(x==y || x+1 == y) return ((bufferString.charAt(y) == table->commandList[cmdIdx].commandString[y]) & isEndOfCommand( bufferString.charAt(table->commandLengths[cmdIdx]) ));
 	}
 	return false; //failed check
 }
@@ -946,7 +1933,8 @@ bool Commander::checkInternalCommand(uint16_t cmdIdx){
 	#if defined BENCHMARKING_ON
 		benchmarkCounter++;
 	#endif
-	/*	"U",	"X",	"?",	"help",	"echo",	"echox",	"errors"}	*/
+	/*	"U",	"X",	"?",	"help",	"echo",	"echox",	"errors",	"stats",	"get",	"set",	"dump",	"watch",	"unwatch"}	*/
+	if(cmdIdx >= INTERNAL_VARIABLE_COMMANDS) return checkVariableCommand(cmdIdx);
 	
 	switch(cmdIdx){
 	case 0:
@@ -1005,6 +1993,14 @@ bool Commander::checkInternalCommand(uint16_t cmdIdx){
 		findNextItem();
 		commandIndex = 6;
 		return true;
+	case 7:
+		if(bufferString.charAt(0) != 's') return false;
+		if(!isEndOfCommand(bufferString.charAt(5)) || !qcheckInternal(cmdIdx) ) return false;
+		dataReadIndex = 5;
+		endIndexOfLastCommand = dataReadIndex;
+		findNextItem();
+		commandIndex = 7;
+		return true;
 	}
 	return 0;
 }
@@ -1024,6 +2020,7 @@ bool Commander::qcheckInternal(uint8_t itm){
 	if(bufferString.charAt(n) != internalCommandArray[itm][n]) return false;
 	if(itm < 6) return true; //match
 	n++; //5
+	if(internalCommandArray[itm][n] == '\0') return true; //stats
 	if(bufferString.charAt(n) != internalCommandArray[itm][n]) return false;
 	return true; //match
 }
@@ -1037,17 +2034,17 @@ Commander& Commander::unchain(){
 Commander& Commander::printDiagnostics(){
 	//print diagnostic data for debugging
 	/*println("Command lengths");
-	for(int n = 0; n < commandListEntries; n++){
+	for(int n = 0; n < table->commandListEntries; n++){
 		print(n);
 		print("= ");
-		println(commandLengths[n]);
+		println(table->commandLengths[n]);
 	}*/
 	println("DIAGNOSTICS-------------:");
 	print("Cmd Idx ");					println(commandIndex);
 	print("Data Read Idx ");		println(dataReadIndex);
 	print("End Idx Last Cmd ");	println(endIndexOfLastCommand);
-	//print("longest Cmd ");			println(longestCommand);
-	//print("Num of Cmds ");			println(commandListEntries);
+	//print("longest Cmd ");			println(table->longestCommand);
+	//print("Num of Cmds ");			println(table->commandListEntries);
 	print("Buffer:");						println(bufferString);
 	print("Payload:");					println(getPayload());
 	
@@ -1161,6 +2158,33 @@ int Commander::handleInternalCommand(uint16_t internalCommandIndex){
 			}
 			return 0;
 			break;
+		case 7: //CMDR command stats
+			if(getString(str)){
+				rewind();
+				str.toLowerCase();
+				if(str == "off") commandStats(false);
+				if(str == "on") commandStats(true);
+				if(str == "reset") resetCommandStats();
+			}
+			printCommandStats();
+			return 0;
+			break;
+		case 8: //get variables
+		case 9: //set variables
+		case 10: //dump variables
+		case 11: //watch variables
+		case 12: //unwatch variables
+			if(ports.settings.bit.locked){
+				println();
+				return 0;
+			}
+			if(internalCommandIndex == 8) getVariables();
+			else if(internalCommandIndex == 9) setVariables();
+			else if(internalCommandIndex == 10) printVariables();
+			else if(internalCommandIndex == 11) watchVariables();
+			else unwatchVariables();
+			return 0;
+			break;
 	}
 	//error
 	return 1;
@@ -1184,7 +2208,7 @@ bool Commander::findNextDelim(){
 		if(DEBUG_INDEXER) println("Delim Search: Started On item. looking for delim");
 		return itemToNextDelim();
 	}
-	println("Delim Search: Started On delim. looking for item");
+	if(DEBUG_INDEXER) println("Delim Search: Started On delim. looking for item");
 	//already in a delimiter, find item first
 	if(delimToNextItem()) return itemToNextDelim();
 	if(DEBUG_INDEXER) println("Delim Search: END Returning 0");
@@ -1212,14 +2236,19 @@ bool Commander::findNextItem(){
 //==============================================================================================================
 bool Commander::delimToNextItem(){
 	//move dataReadIndex from a delimiter to the next item
-	while(isDelimiter(bufferString.charAt(dataReadIndex))){
-		if(isEndOfLine(bufferString.charAt(dataReadIndex))){
-			
+	//scans the raw buffer - the null terminator is not a delimiter so the scan always stops
+	if(dataReadIndex >= bufferString.length()) return 1;
+	const char* buf = bufferString.c_str();
+	uint16_t idx = dataReadIndex;
+	while(isDelimiter(buf[idx])){
+		if(isEndOfLine(buf[idx])){
+			dataReadIndex = idx;
 			if(DEBUG_INDEXER) println("delimToNextItem: END OF LINE");
 			return 0;
 		}
-		dataReadIndex++;
+		idx++;
 	}
+	dataReadIndex = idx;
 	if(DEBUG_INDEXER) print("delimToNextItem: Item Found at: ");
 	if(DEBUG_INDEXER) println(dataReadIndex);
 	return 1;
@@ -1228,42 +2257,58 @@ bool Commander::delimToNextItem(){
 bool Commander::itemToNextDelim(){
 		//move dataReadIndex from an item to the next delimiter
 		//If you start on a quote, don't stop until you get another
-	//bool endOnQuote = false;
-	if(!ports.settings.bit.ignoreQuotes){
-		if(bufferString.charAt(dataReadIndex) == '"'){
-			//print("Found open quote at ");
-			//println(dataReadIndex);
-			dataReadIndex++;
-			while(bufferString.charAt(dataReadIndex) != '"'){
-				if(isEndOfLine(bufferString.charAt(dataReadIndex))){
-					return 0;
-				}
-				dataReadIndex++;
-			}
+	//the end of the buffer is treated as the end of the line
+	if(dataReadIndex >= bufferString.length()) return 0;
+	const char* buf = bufferString.c_str();
+	uint16_t idx = dataReadIndex;
+	if(!ports.settings.bit.ignoreQuotes && buf[idx] == '"'){
+		//jump straight to the closing quote or the end of the line
+		const char stopChars[3] = {'"', endOfLineCharacter, '\0'};
+		const char* stop = strpbrk(&buf[idx+1], stopChars);
+		if(stop == NULL || *stop != '"'){
+			dataReadIndex = (stop == NULL) ? bufferString.length() : (uint16_t)(stop - buf);
+			return 0;
 		}
+		idx = stop - buf;
 	}
-	while(!isDelimiter(bufferString.charAt(dataReadIndex))){
-		if(isEndOfLine(bufferString.charAt(dataReadIndex))){
+	char ch = buf[idx];
+	while(!isDelimiter(ch)){
+		if(isEndOfLine(ch) || ch == '\0'){
+			dataReadIndex = idx;
 			if(DEBUG_INDEXER) println("itemToNextDelim: END OF LINE");
 			return 0;
 		}
-		dataReadIndex++;
+		ch = buf[++idx];
 	}
+	dataReadIndex = idx;
 	if(DEBUG_INDEXER) print("itemToNextDelim: Item Found at: ");
 	if(DEBUG_INDEXER) println(dataReadIndex);
 	return 1;
 }
 //==============================================================================================================
-bool Commander::isDelimiter(char ch){
-	//this should be called is delimiter
-	//it looks for a space or the eoc character (=)
+void Commander::buildDelimiterMap(){
+	//set one bit per delimiter char so isDelimiter() is a single lookup instead of a search
+	//objects with the default delimiters share one map, a map is only allocated for an object with its own delimiters
+	uint8_t* map = defaultDelimiterMap;
+	if(delimiterMap != NULL && delimiterMap != defaultDelimiterMap) map = delimiterMap; //once an object has its own map it keeps it
+	else if(delimiterChars == DEFAULT_DELIMITERS){
+		if(defaultDelimiterMapBuilt){
+			delimiterMap = defaultDelimiterMap;
+			return;
+		}
+		defaultDelimiterMapBuilt = true;
+	}else{
+		map = new uint8_t[32];
+		if(map == NULL) return; //keep the old map
+	}
+	memset(map, 0, 32);
 	for(uint8_t n = 0; n < delimiterChars.length(); n++){
-		if(ch == delimiterChars.charAt(n)) return 1;
+		uint8_t ch = (uint8_t)delimiterChars.charAt(n);
+		map[ch >> 3] |= (1 << (ch & 7));
 	}
-	//if(ch == delimChar || ch == ' ') return 1;
-	return 0;
+	delimiterMap = map;
 }
-
+//==============================================================================================================
 bool Commander::isItem(char ch){
 	if(isDelimiter(ch)) return false;
 	if(isEndOfLine(ch)) return false;
@@ -1273,11 +2318,93 @@ bool Commander::isItem(char ch){
 //==============================================================================================================
 Commander& Commander::rewind(){
 	//rewind dataReadIndex to the start of the first item
+	if(commandState.bit.itemsValid && itemCount > 0){
+		itemIndex = 0;
+		dataReadIndex = items[0].start;
+		return *this;
+	}
 	dataReadIndex = endIndexOfLastCommand;
 	findNextItem();
 	return *this;
 }
 //==============================================================================================================
+void Commander::splitItems(){
+	//Split the payload into items once, recording where each one starts and ends, so the getters don't have to search the buffer again.
+	//This steps through the buffer in exactly the same way as findNextItem(). dataReadIndex must be on the first item.
+	itemCount = 0;
+	itemIndex = 0;
+	commandState.bit.itemsOverflow = false;
+	commandState.bit.itemsValid = true;
+	if(dataReadIndex == 0) return; //no payload
+	uint16_t firstItem = dataReadIndex;
+	while(true){
+		if(itemCount == itemCapacity){
+			//the getters will search the buffer for anything after the last item in the table
+			commandState.bit.itemsOverflow = true;
+			break;
+		}
+		uint16_t start = dataReadIndex;
+		bool more = itemToNextDelim();
+		items[itemCount].start = start;
+		items[itemCount].length = dataReadIndex - start;
+		items[itemCount].quoted = (bufferString.charAt(start) == '"');
+		itemCount++;
+		if(!more || !delimToNextItem()) break;
+	}
+	dataReadIndex = firstItem;
+}
+//==============================================================================================================
+bool Commander::syncItem(){
+	//make sure itemIndex refers to the item at dataReadIndex, returns false if dataReadIndex is not at the start of an item in the table
+	if(!commandState.bit.itemsValid || itemCount == 0) return false;
+	if(itemIndex < itemCount && items[itemIndex].start == dataReadIndex) return true;
+	//dataReadIndex was moved somewhere else (quickSet does this) so look it up
+	uint8_t lo = 0, hi = itemCount;
+	while(lo < hi){
+		uint8_t mid = (lo + hi) / 2;
+		if(items[mid].start < dataReadIndex) lo = mid + 1;
+		else hi = mid;
+	}
+	if(lo < itemCount && items[lo].start == dataReadIndex){
+		itemIndex = lo;
+		return true;
+	}
+	return false;
+}
+//==============================================================================================================
+bool Commander::nextItem(){
+	//move dataReadIndex to the next item, using the item table if possible
+	if(syncItem()){
+		if(itemIndex+1 < itemCount){
+			itemIndex++;
+			dataReadIndex = items[itemIndex].start;
+			return 1;
+		}
+		if(!commandState.bit.itemsOverflow) return 0;
+	}
+	return findNextItem();
+}
+//==============================================================================================================
+Commander& Commander::itemTable(uint8_t size){
+	//set the number of items this object's item table holds, 0 to always search the buffer
+	if(size == itemCapacity) return *this;
+	if(items) delete [] items;
+	items = size ? new cmdItem_t[size] : NULL;
+	itemCapacity = items ? size : 0;
+	itemCount = 0;
+	itemIndex = 0;
+	commandState.bit.itemsValid = false;
+	return *this;
+}
+//==============================================================================================================
+cmdItem_t Commander::getItem(uint8_t index){
+	cmdItem_t item;
+	item.length = 0;
+	item.quoted = 0;
+	if(commandState.bit.itemsValid && index < itemCount) item = items[index];
+	return item;
+}
+//==============================================================================================================
 //Try to find the next numeral from where readIndex is
 bool Commander::tryGet(){
 	if(dataReadIndex < endIndexOfLastCommand){
@@ -1290,29 +2417,341 @@ bool Commander::tryGet(){
 	return 0;
 }
 //==============================================================================================================
-bool Commander::isNumber(String &str){
+bool Commander::isNumber(const CommandBuffer &str){
 	//returns true if the first character is a valid number, or a minus sign followed by a number
 	if( isNumeral( str.charAt(0) ) ) return true;
 	if(str.charAt(0) == 45 && isNumeral( str.charAt(1) )) return true;
 	return false;
 }
 //==============================================================================================================
-bool Commander::isNumeral(char ch){
-	if(ch > 47 && ch < 58) return true;
-	return false;
+bool Commander::matchOpcode(){
+	//look up the number at the start of the buffer in the opcode table
+	//the number must be a whole item, so "12.5" or "12abc" are left for the special handler
+	if(opcodeTable == NULL) return false;
+	int64_t opcode = 0;
+	uint8_t status = PARSE_OK;
+	const char* start = bufferString.c_str();
+	const char* end = parseInteger(start, opcode, status);
+	if(status != PARSE_OK || opcode != (int32_t)opcode) return false;
+	//the integer parser stops at a decimal point, exponent or suffix, so 12.5, 1e1 and 1k are not whole items either
+	if(*end != '\0' && *end != '\r' && !isEndOfCommand(*end)) return false;
+	int idx = opcodeTable->find((int32_t)opcode);
+	if(idx < 0) return false;
+	commandIndex = idx;
+	dataReadIndex = end - start;
+	return true;
+}
+//==============================================================================================================
+int32_t Commander::getOpcode(){
+	if(commandState.bit.commandType != OPCODE_COMMAND || opcodeTable == NULL) return 0;
+	return opcodeTable->list()[commandIndex].opcode;
+}
+//==============================================================================================================
+bool Commander::checkVariableCommand(uint16_t cmdIdx){
+	//the variable commands only exist when a variable table is attached
+	if(variableTable == NULL) return false;
+	uint8_t length = strlen(internalCommandArray[cmdIdx]);
+	if(!isEndOfCommand(bufferString.charAt(length))) return false;
+	if(strncmp(bufferString.c_str(), internalCommandArray[cmdIdx], length) != 0) return false;
+	dataReadIndex = length;
+	endIndexOfLastCommand = dataReadIndex;
+	if(!findNextItem()) dataReadIndex = 0;
+	commandIndex = cmdIdx;
+	return true;
+}
+//==============================================================================================================
+Commander& Commander::printVariables(){
+	//print every variable. Replies are not flushed at the end of each line so if outputBuffer() is on they go out in whole blocks
+	if(variableTable == NULL) return *this;
+	bool hold = commandState.bit.holdOutput;
+	commandState.bit.holdOutput = true;
+	for(uint8_t n = 0; n < variableTable->entries(); n++) printVariable(n);
+	commandState.bit.holdOutput = hold;
+	return *this;
+}
+//==============================================================================================================
+void Commander::printVariable(uint8_t idx){
+	print(variableTable->list()[idx].name);
+	write('=');
+	printValue(idx);
+	println();
+}
+//==============================================================================================================
+void Commander::printValue(uint8_t idx){
+	const variableList_t &var = variableTable->list()[idx];
+	switch(var.type){
+	case VAR_INT:
+		printNumber(*(int*)var.variable);
+		break;
+	case VAR_FLOAT:
+		printNumber(*(float*)var.variable, variableTable->precision());
+		break;
+	case VAR_DOUBLE:
+		printNumber(*(double*)var.variable, variableTable->precision());
+		break;
+	case VAR_BOOL:
+		write(*(bool*)var.variable ? '1' : '0');
+		break;
+	case VAR_STRING:{
+		//quote the string if it wouldn't be read back as one item
+		const String &str = *(String*)var.variable;
+		bool quote = str.length() == 0;
+		for(uint16_t n = 0; n < str.length() && !quote; n++) quote = isEndOfCommand(str.charAt(n));
+		if(quote) write('"');
+		print(str);
+		if(quote) write('"');
+		break;
+	}
+	}
+}
+//==============================================================================================================
+int Commander::variableAtCursor(){
+	//look up the item at dataReadIndex in the variable table and move on to the next item
+	uint16_t start = dataReadIndex;
+	uint16_t length = 0;
+	if(syncItem()) length = items[itemIndex].length;
+	else{
+		itemToNextDelim();
+		length = dataReadIndex - start;
+		dataReadIndex = start;
+	}
+	int idx = variableTable->find(bufferString.c_str() + start, length);
+	if(!nextItem()) dataReadIndex = 0;
+	if(idx < 0 && ports.settings.bit.errorMessagesEnabled){
+		print(F("#Variable: \'"));
+		write((const uint8_t*)bufferString.c_str() + start, length);
+		println(F("\' not recognised"));
+	}
+	return idx;
 }
 //==============================================================================================================
-bool Commander::isEndOfLine(char dataByte){
-	return dataByte == endOfLineCharacter;
-  //(dataByte == endOfLineCharacter) ? return true : return false;
+void Commander::getVariables(){
+	//print each variable named in the payload, or all of them if there are no names
+	if(!hasPayload()){
+		printVariables();
+		return;
+	}
+	bool hold = commandState.bit.holdOutput;
+	commandState.bit.holdOutput = true;
+	while(dataReadIndex > 0){
+		int idx = variableAtCursor();
+		if(idx > -1) printVariable(idx);
+	}
+	commandState.bit.holdOutput = hold;
+}
+//==============================================================================================================
+void Commander::setVariables(){
+	//set each name value pair in the payload and print the new value
+	bool hold = commandState.bit.holdOutput;
+	commandState.bit.holdOutput = true;
+	while(dataReadIndex > 0){
+		int idx = variableAtCursor();
+		if(idx < 0){
+			if(dataReadIndex > 0 && !nextItem()) dataReadIndex = 0; //skip the value
+			continue;
+		}
+		uint16_t valueStart = dataReadIndex;
+		if(valueStart > 0 && setVariable(idx)){
+			printVariable(idx);
+			continue;
+		}
+		if(ports.settings.bit.errorMessagesEnabled){
+			print(F("#Variable: \'"));
+			print(variableTable->list()[idx].name);
+			println(valueStart > 0 ? F("\' bad value") : F("\' no value"));
+		}
+		dataReadIndex = valueStart;
+		if(dataReadIndex > 0 && !nextItem()) dataReadIndex = 0;
+	}
+	commandState.bit.holdOutput = hold;
+}
+//==============================================================================================================
+void Commander::watchVariables(){
+	//watch the variables named in the payload. A number sets the period in ms and 'change' only sends values that have changed
+	//with no payload, list the variables being watched
+	if(!hasPayload()){
+		for(uint8_t n = 0; n < watchCount; n++){
+			print(variableTable->list()[watchList[n].variable].name);
+			write(' ');
+			printNumber(watchList[n].period);
+			println(watchList[n].onChange ? F(" change") : F(""));
+		}
+		return;
+	}
+	//find the period and options first so they apply to every name on the line
+	uint16_t period = DEFAULT_WATCH_PERIOD;
+	bool onChange = false;
+	String option;
+	uint16_t firstItem = dataReadIndex;
+	while(dataReadIndex > 0){
+		if(tryGet()){
+			int32_t value = 0;
+			getInt(value);
+			if(value >= 0) period = value > 0xFFFF ? 0xFFFF : value;
+		}else{
+			getString(option);
+			option.toLowerCase();
+			if(option == "change") onChange = true;
+		}
+	}
+	if(period < MIN_WATCH_PERIOD){
+		period = MIN_WATCH_PERIOD;
+		if(ports.settings.bit.errorMessagesEnabled){
+			print(F("#Watch: period raised to "));
+			printNumber(period);
+			println(F("ms"));
+		}
+	}
+	dataReadIndex = firstItem;
+	while(dataReadIndex > 0){
+		if(tryGet()){
+			if(!nextItem()) dataReadIndex = 0;
+			continue;
+		}
+		uint16_t start = dataReadIndex;
+		char end = bufferString.charAt(start+6);
+		if(strncasecmp(bufferString.c_str() + start, "change", 6) == 0 && (end == '\0' || end == '\r' || isEndOfCommand(end))){
+			if(!nextItem()) dataReadIndex = 0;
+			continue;
+		}
+		int idx = variableAtCursor();
+		if(idx < 0) continue;
+		if(!addWatch(idx, period, onChange) && ports.settings.bit.errorMessagesEnabled){
+			print(F("#Variable: \'"));
+			print(variableTable->list()[idx].name);
+			println(F("\' too many watches"));
+		}
+	}
+}
+//==============================================================================================================
+void Commander::unwatchVariables(){
+	//stop watching the variables named in the payload, or all of them if there are no names
+	if(!hasPayload()){
+		watchCount = 0;
+		return;
+	}
+	while(dataReadIndex > 0){
+		int idx = variableAtCursor();
+		if(idx > -1) removeWatch(idx);
+	}
+}
+//==============================================================================================================
+bool Commander::watchVariable(const char* name, uint16_t periodMs, bool onChange){
+	if(variableTable == NULL) return false;
+	int idx = variableTable->find(name);
+	if(idx < 0) return false;
+	return addWatch(idx, periodMs, onChange);
+}
+//==============================================================================================================
+Commander& Commander::unwatchVariable(const char* name){
+	if(variableTable == NULL) return *this;
+	int idx = variableTable->find(name);
+	if(idx > -1) removeWatch(idx);
+	return *this;
 }
 //==============================================================================================================
-bool Commander::isEndOfCommand(char dataByte){
-	if(dataByte == endOfLineCharacter) return true;
-	return isDelimiter(dataByte);
-	//if(dataByte == ' ') return true;
-	//if(dataByte == delimChar) return true;
-  //return false;
+bool Commander::addWatch(uint8_t idx, uint16_t periodMs, bool onChange){
+	//add a variable to the watch list, or change its period if it is already there
+	if(periodMs < MIN_WATCH_PERIOD) periodMs = MIN_WATCH_PERIOD;
+	uint8_t n = 0;
+	while(n < watchCount && watchList[n].variable != idx) n++;
+	if(n == watchCount){
+		if(watchList == NULL) watchList = new watch_t[COMMANDER_MAX_WATCHES];
+		if(watchList == NULL || watchCount == COMMANDER_MAX_WATCHES) return false;
+		watchCount++;
+	}
+	watchList[n].variable = idx;
+	watchList[n].period = periodMs;
+	watchList[n].onChange = onChange;
+	watchList[n].lastSample = millis() - periodMs; //send the first sample on the next update
+	watchList[n].fingerprint = ~variableTable->fingerprint(idx);
+	return true;
+}
+//==============================================================================================================
+void Commander::removeWatch(uint8_t idx){
+	for(uint8_t n = 0; n < watchCount; n++){
+		if(watchList[n].variable != idx) continue;
+		watchList[n] = watchList[--watchCount];
+		return;
+	}
+}
+//==============================================================================================================
+void Commander::serviceWatches(){
+	//print every watched variable that is due on one line as name=value pairs
+	//the line can be sent back with set to restore the values
+	if(ports.settings.bit.locked || variableTable == NULL) return;
+	uint32_t now = millis();
+	bool lineStarted = false;
+	for(uint8_t n = 0; n < watchCount; n++){
+		watch_t &watch = watchList[n];
+		if(now - watch.lastSample < watch.period) continue;
+		//keep to the period unless we have fallen more than a whole period behind
+		watch.lastSample = (now - watch.lastSample < 2UL * watch.period) ? watch.lastSample + watch.period : now;
+		if(watch.onChange){
+			uint32_t fingerprint = variableTable->fingerprint(watch.variable);
+			if(fingerprint == watch.fingerprint) continue;
+			watch.fingerprint = fingerprint;
+		}
+		if(lineStarted) write(' ');
+		print(variableTable->list()[watch.variable].name);
+		write('=');
+		printValue(watch.variable);
+		lineStarted = true;
+	}
+	if(lineStarted) println();
+}
+//==============================================================================================================
+bool Commander::setVariable(uint8_t idx){
+	//parse the item at dataReadIndex into the variable, clamping numbers to its range
+	const variableList_t &var = variableTable->list()[idx];
+	bool limited = var.min < var.max;
+	switch(var.type){
+	case VAR_INT:{
+		int64_t value = 0;
+		if(!getInteger(value) || parseStatus != PARSE_OK) return false;
+		if(limited && value < var.min) value = (int64_t)var.min;
+		if(limited && value > var.max) value = (int64_t)var.max;
+		if((int)value != value) return false;
+		*(int*)var.variable = (int)value;
+		return true;
+	}
+	case VAR_FLOAT:{
+		float value = 0;
+		if(!getFloat(value) || parseStatus != PARSE_OK) return false;
+		if(limited && value < var.min) value = var.min;
+		if(limited && value > var.max) value = var.max;
+		*(float*)var.variable = value;
+		return true;
+	}
+	case VAR_DOUBLE:{
+		double value = 0;
+		if(!getDouble(value) || parseStatus != PARSE_OK) return false;
+		if(limited && value < var.min) value = var.min;
+		if(limited && value > var.max) value = var.max;
+		*(double*)var.variable = value;
+		return true;
+	}
+	case VAR_BOOL:{
+		const char* item = bufferString.c_str() + dataReadIndex;
+		uint16_t length = syncItem() ? items[itemIndex].length : 0;
+		if(length == 0) while(!isEndOfCommand(item[length]) && item[length] != '\0' && item[length] != '\r') length++;
+		bool value;
+		if((length == 1 && item[0] == '1') || (length == 4 && strncasecmp(item, "true", 4) == 0) || (length == 2 && strncasecmp(item, "on", 2) == 0)) value = true;
+		else if((length == 1 && item[0] == '0') || (length == 5 && strncasecmp(item, "false", 5) == 0) || (length == 3 && strncasecmp(item, "off", 3) == 0)) value = false;
+		else return false;
+		*(bool*)var.variable = value;
+		if(!nextItem()) dataReadIndex = 0;
+		return true;
+	}
+	case VAR_STRING:
+		return getString(*(String*)var.variable);
+	}
+	return false;
+}
+//==============================================================================================================
+bool Commander::isNumeral(char ch){
+	if(ch > 47 && ch < 58) return true;
+	return false;
 }
 //==============================================================================================================
 
@@ -1325,9 +2764,12 @@ Commander& Commander::printCommandList(){
 	  //If so then reload the payload and set quickHelp to true.
 		//on reloading, when the command is matched, it should print the contents of the extraHelp array at the index for the command
 		//This checks to see if the buffer contains more characters than 'help'+2 because the next character could be a delimiter, and there will be an end of line char as well
-	if( extraHelp != NULL && bufferString.length() > 6){//charAt(4) != endOfLineCharacter ){
+	//only this command's part of the line counts when it was split by a separator
+	uint16_t lineLength = chainEnd ? chainEnd : bufferString.length();
+	if( extraHelp != NULL && lineLength > 6){//charAt(4) != endOfLineCharacter ){
 		commandState.bit.quickHelp = true;
 		bufferString.remove(0, endIndexOfLastCommand+1);
+		if(chainEnd) chainEnd -= endIndexOfLastCommand+1;
 		//Serial.print(bufferString);
 		//keep this command prompt disabled if it wasn't already
 		commandPrompt(OFF); //dsiable the prompt so it doesn't print twice
@@ -1343,7 +2785,7 @@ Commander& Commander::printCommandList(){
 	cmdLine.concat(commanderName);
 	cmdLine.concat(F(" User Commands:"));
 	println(cmdLine);
-  for(n = 0; n < commandListEntries; n++) if(commandList[n].manualString[0] != CMD_HIDE_HELP) {
+  for(n = 0; n < table->commandListEntries; n++) if(table->commandList[n].manualString[0] != CMD_HIDE_HELP) {
 		write(commentCharacter);
 		println(getCommandItem(n));
 	}
@@ -1364,6 +2806,7 @@ Commander& Commander::printCommandList(){
 	write(commentCharacter);
   println(F(" Internal Commands:"));
 	for(n = 0; n < INTERNAL_COMMAND_ITEMS; n++){
+		if(n >= INTERNAL_VARIABLE_COMMANDS && variableTable == NULL) break;
 		write(commentCharacter);
 		println(getInternalCommandItem(n));
 	}
@@ -1387,11 +2830,11 @@ Commander& Commander::printCommanderVersion(){
 	if(userString != NULL) println(*userString);
 	write(commentCharacter);
 	print(F("\tCommander version "));
-	print(majorVersion);
-	print(".");
-	print(minorVersion);
-	print(".");
-	println(subVersion);
+	printNumber(majorVersion);
+	write('.');
+	printNumber(minorVersion);
+	write('.');
+	printNumber(subVersion).println();
 	
 	write(commentCharacter);
 	print(F("\tEcho terminal: "));
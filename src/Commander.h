@@ -6,11 +6,18 @@
 #include <Arduino.h>
 #include <string.h>
 #include "utilities/CommandHelpTags.h"
+#include "utilities/CommandBuffer.h"
+#include "utilities/CommandTable.h"
+#include "utilities/OpcodeTable.h"
+#include "utilities/VariableTable.h"
+#include "utilities/NumberParser.h"
+#include "utilities/NumberFormat.h"
+#include "utilities/BinaryFrame.h"
 
 class Commander;
 
 const uint8_t majorVersion = 4;
-const uint8_t minorVersion = 3;
+const uint8_t minorVersion = 4;
 const uint8_t subVersion   = 0;
 
 
@@ -30,35 +37,37 @@ const uint8_t subVersion   = 0;
 #ifndef DISABLED
 	#define DISABLED false
 #endif
-typedef bool (*cmdHandler)(Commander& Cmdr); //command handler function pointer type
-//Command handler array type - contains command string and function pointer
-
-typedef struct commandList_t{
-	const char* commandString;
-  cmdHandler handler;
-	const char* manualString;
-} commandList_t;
-
 //extern const commandList_t myCommands[];
 	
 typedef union {
   struct {
-		uint16_t newLine:1; 					//end of line was detected
-    uint16_t bufferFull:1;  			//buffer is full
-    uint16_t isCommandPending:1; 	//another command is in the pending command string
-		uint16_t bufferState:1; 			//the state of the command buffer
-		uint16_t commandHandled:1; 		//flag set if a command was handled during the last update
-		uint16_t quickHelp:1; 				//flag set to true if quick help requested
-		uint16_t quickSetCalled:1; 		//Flags that the current command is a quickset - chaining must break here
-		uint16_t prefixMessage:1; 		//flag to indicate that any replies should be prefixed with the prefix string
-		uint16_t postfixMessage:1; 		//flag to indicate that any replies should be appended with the postfix string
-		uint16_t newlinePrinted:1; 		//flag to indicate that a newline has been sent - used with the prefixMessage flag to ensure prefix string appears at the start of every line
-		uint16_t dataStreamOn:1; 			//indicates that a data stream is active and in one of two modes
-		uint16_t chain:1; 						//Chain commands - reload the buffer after a command to see if there are more commands
-		uint16_t chaining:1; 					//Flags that the current command is an attempt to chain and so errors should be surpressed.
-		uint16_t commandType:3;				//Indicates which command type was last identified
+		uint32_t newLine:1; 					//end of line was detected
+    uint32_t bufferFull:1;  			//buffer is full
+    uint32_t isCommandPending:1; 	//another command is in the pending command string
+		uint32_t bufferState:1; 			//the state of the command buffer
+		uint32_t commandHandled:1; 		//flag set if a command was handled during the last update
+		uint32_t quickHelp:1; 				//flag set to true if quick help requested
+		uint32_t quickSetCalled:1; 		//Flags that the current command is a quickset - chaining must break here
+		uint32_t prefixMessage:1; 		//flag to indicate that any replies should be prefixed with the prefix string
+		uint32_t postfixMessage:1; 		//flag to indicate that any replies should be appended with the postfix string
+		uint32_t newlinePrinted:1; 		//flag to indicate that a newline has been sent - used with the prefixMessage flag to ensure prefix string appears at the start of every line
+		uint32_t dataStreamOn:1; 			//indicates that a data stream is active and in one of two modes
+		uint32_t chain:1; 						//Chain commands - reload the buffer after a command to see if there are more commands
+		uint32_t chaining:1; 					//Flags that the current command is an attempt to chain and so errors should be surpressed.
+		uint32_t commandType:3;				//Indicates which command type was last identified
+		uint32_t matchTracking:1;			//the command is being matched as bytes are written to the buffer
+		uint32_t itemsValid:1;				//the item table holds the items for the current command
+		uint32_t itemsOverflow:1;			//there were more items than the item table holds
+		uint32_t txTruncating:1;			//the transmit queue filled part way through a line and the rest of the line is being dropped
+		uint32_t frameReceiving:1;		//a binary frame is being written to the buffer
+		uint32_t binaryFrame:1;				//the handler was called by a binary frame - replies go in the reply frame
+		uint32_t streamHalf:1;				//which half of the stream block is being filled
+		uint32_t unknownCommand:1;		//the last command was not recognised
+		uint32_t chainPending:1;			//the pending command is the rest of a chained line
+		uint32_t holdOutput:1;				//staged replies are not flushed at the end of each line
+		uint32_t stringOverflow:1;		//the last string given to feedString() or loadString() didn't fit in the buffer
   } bit;        // used for bit  access  
-  uint16_t reg;  //used for register access 
+  uint32_t reg;  //used for register access 
 } cmdState_t;
 #define STREAM_MODE_EOF false
 #define STREAM_MODE_PURE true
@@ -91,6 +100,13 @@ typedef union {
 		uint32_t autoChain:1; 							//19 Automatically chain commands, and to hell with the consequences
 		uint32_t autoChainSurpressErrors:1;	//20 Prevent error messages when chaining commands
 		uint32_t ignoreQuotes:1;						//21 don't treat items in quotes as special
+		uint32_t bulkRead:1;								//22 read the input stream in blocks instead of one byte at a time
+		uint32_t commandStats:1;						//23 record hit counts and handler times for each command
+		uint32_t bufferOutput:1;						//24 stage replies in the output buffer and write them to the out port in blocks
+		uint32_t queueOutput:1;							//25 queue data for the out port and send it from update() when the port has room
+		uint32_t txPolicy:2;								//26-27 what to do when the transmit queue is full (drop, block, truncate)
+		uint32_t binaryFrames:1;						//28 accept binary frames as well as text commands
+		uint32_t engineeringSuffixes:1;			//29 accept engineering suffixes (1.5k, 10m) when parsing numbers
   } bit;        // used for bit  access  
   uint32_t reg;  //used for register access 
 } cmdSettings_t; 
@@ -99,6 +115,13 @@ typedef union {
 //default is 	0b 0  0  0  0  0  0  0  0  0  0  0  0  0  0  0  0  0  1  0  0  0  1  0  1  1  1  0  1  1  0  0  0
 
 
+//What to do with reply data when the transmit queue is full
+typedef enum txPolicy_t{
+	TX_DROP 		= 0, //drop the data that does not fit
+	TX_BLOCK 		= 1, //wait for the out port to take the queued data, the same as having no queue
+	TX_TRUNCATE = 2, //drop the rest of the line that did not fit but keep its end of line
+} txPolicy_t;
+
 typedef enum streamType_t{
 	UNDEFINED_STREAM 	= 0,
 	SERIAL_STREAM 		= 1,
@@ -106,6 +129,117 @@ typedef enum streamType_t{
 	WEB_STREAM 				= 3,
 } streamType_t;
 
+//default size of the item table for each Commander object, itemTable() changes it for one object
+#ifndef COMMANDER_MAX_ITEMS
+	#if defined(__AVR__)
+		#define COMMANDER_MAX_ITEMS 12
+	#else
+		#define COMMANDER_MAX_ITEMS 32
+	#endif
+#endif
+
+#ifndef COMMANDER_MAX_WATCHES
+	#if defined(__AVR__)
+		#define COMMANDER_MAX_WATCHES 8
+	#else
+		#define COMMANDER_MAX_WATCHES 32
+	#endif
+#endif
+
+#ifndef COMMAND_STATS_BINS
+	#define COMMAND_STATS_BINS 16
+#endif
+
+//Hit count and handler times for one command, recorded when commandStats is enabled
+//Times are in microseconds. Histogram bin n counts handler times from 2^(n-1) to 2^n - 1 (bin 0 is 0us), the last bin counts everything longer
+typedef struct cmdStats_t{
+	uint32_t hits = 0;
+	uint32_t minTime = 0xFFFFFFFF;
+	uint32_t maxTime = 0;
+	uint32_t totalTime = 0; 	//mean time is totalTime / hits
+	uint16_t histogram[COMMAND_STATS_BINS] = {0};
+} cmdStats_t;
+
+//The stats for one command list. Each list that has been used keeps its own stats, so switching command tables doesn't lose them
+typedef struct cmdStatsBlock_t{
+	const commandList_t* list; 	//the command list these stats are for
+	uint16_t entries; 					//number of commands in the list
+	cmdStats_t* stats;
+	cmdStatsBlock_t* next;
+} cmdStatsBlock_t;
+
+//The state for each optional feature is allocated the first time the feature is enabled, so a Commander that doesn't use it only holds a pointer
+//Input read in blocks when bulkRead is enabled
+typedef struct readBlock_t{
+	uint8_t* data;
+	uint16_t size;
+	uint16_t head; 		//next unprocessed byte
+	uint16_t tail; 		//end of the data
+	uint16_t echoed; 	//end of the data that has been echoed
+} readBlock_t;
+
+//Replies staged for the out port when bufferOutput is enabled
+typedef struct outBlock_t{
+	uint8_t* data;
+	uint16_t size;
+	uint16_t length;
+} outBlock_t;
+
+//Ring buffer of data for the out port when queueOutput is enabled
+typedef struct txQueue_t{
+	uint8_t* data;
+	uint16_t size;
+	uint16_t head; 		//oldest byte in the queue
+	uint16_t count; 	//number of bytes in the queue
+	uint32_t dropped; //bytes dropped because the queue was full
+} txQueue_t;
+
+//Binary frame state when binaryFrames is enabled
+typedef struct frameState_t{
+	uint8_t* reply; 	//arguments for the reply frame
+	uint8_t replySize;
+	uint8_t replyLength;
+	uint16_t read; 		//next argument byte in the buffer while a frame is handled
+	uint16_t end;
+	uint32_t startTime; //millis() when the start byte arrived
+} frameState_t;
+
+//Position of an item in the payload - the payload is split into items once when a command is matched
+typedef struct cmdItem_t{
+	uint16_t start = 0; 		//index of the first char of the item in the buffer
+	uint16_t length:15; 		//number of chars up to the next delimiter or end of line
+	uint16_t quoted:1; 			//the item starts with a quote
+} cmdItem_t;
+
+//Handler for data streams that are read in blocks - called with each chunk of the stream
+typedef bool (*streamHandler)(Commander& Cmdr, const uint8_t* data, size_t length);
+
+//Stream data passed to a stream handler in chunks, allocated when a stream handler is attached
+typedef struct streamBlock_t{
+	streamHandler handler;
+	uint8_t* data; 		//two chunks - one is filled while the handler can still use the other
+	uint16_t chunk;
+	uint16_t length; 	//bytes in the chunk being filled
+	uint32_t lastByte; //millis() when stream data last arrived
+} streamBlock_t;
+
+//Result of running a script with runScript()
+typedef struct scriptResult_t{
+	uint32_t lines = 0; 				//number of command lines handled
+	uint32_t errors = 0; 				//lines that were not recognised or where the handler returned an error
+	uint32_t firstError = 0; 		//the line number (counting command lines from 1) of the first error, 0 if there were none
+	uint32_t time = 0; 					//milliseconds taken to run the script
+	bool stopped = false; 			//the script stopped at an error before the end
+} scriptResult_t;
+
+typedef struct watch_t{
+	uint8_t variable; 			//index in the variable table
+	uint8_t onChange; 			//only send the value if it has changed
+	uint16_t period; 				//milliseconds between samples
+	uint32_t lastSample; 		//millis() when the variable was last due
+	uint32_t fingerprint; 	//fingerprint of the last value that was sent
+} watch_t;
+
 typedef struct portSettings_t{
 	Stream *inPort = NULL;
 	Stream *outPort = NULL;
@@ -129,9 +263,11 @@ typedef struct portSettings_t{
 #define CUSTOM_COMMAND 										  2
 #define INTERNAL_COMMAND 										3
 #define COMMENT_COMMAND 										4
+#define OPCODE_COMMAND 											5
 
 
-#define INTERNAL_COMMAND_ITEMS 							7
+#define INTERNAL_COMMAND_ITEMS 							13
+#define INTERNAL_VARIABLE_COMMANDS 					8 //get, set, dump, watch and unwatch are only enabled when a variable table is attached
 
 #define COMMANDER_DEFAULT_REGISTER_SETTINGS 0b00000000000000000100010111011000
 //Default settings:
@@ -150,6 +286,19 @@ typedef struct portSettings_t{
 #define HARD_LOCK true
 #define SOFT_LOCK false
 const uint16_t SBUFFER_DEFAULT = 128;
+const char DEFAULT_DELIMITERS[] = "= :,\t\\/|";
+const uint16_t DEFAULT_READ_BLOCK = 64;
+const uint16_t DEFAULT_OUTPUT_BLOCK = 64;
+const uint16_t DEFAULT_TX_QUEUE = 256;
+const uint16_t DEFAULT_TX_CHUNK = 32; //bytes sent per update() when the port doesn't report its room with availableForWrite()
+const uint8_t  DEFAULT_FRAME_REPLY = 64;
+const uint16_t FRAME_TIMEOUT = 100; //milliseconds before a part received binary frame is dropped
+#if defined(__AVR__)
+	const uint16_t DEFAULT_STREAM_CHUNK = 64;
+#else
+	const uint16_t DEFAULT_STREAM_CHUNK = 512; //one SD card sector
+#endif
+const uint16_t STREAM_IDLE_TIME = 20; //milliseconds without data before a part filled stream chunk is passed to the handler
 	
 //some const strings for common messages
 const String onString = "on";
@@ -166,11 +315,15 @@ class Commander : public Stream {
 public:
 	Commander();
 	Commander(uint16_t reservedBuffer);
+	~Commander();
 	Commander&   begin(Stream *sPort);
 	Commander&	 begin(Stream *sPort, const commandList_t *commands, uint32_t size);
 	Commander&	 begin(Stream *sPort, Stream *oPort, const commandList_t *commands, uint32_t size);
+	Commander&	 begin(Stream *sPort, CommandTable& commands);
 	Commander&	 begin(const commandList_t *commands, uint32_t size);
 	bool   update();
+	bool   update(uint32_t budgetMicros); //handle commands until the input is empty or budgetMicros have passed, returns true if there is more to do
+	uint16_t commandsRun() 							{return commandCount;} //number of commands handled by the last update
 	Commander&	 setPassPhrase(String& phrase) 	{passPhrase = &phrase; return *this;}
 	Commander&   printPassPhrase() 							{print(*passPhrase); return *this;}
 	Commander&	 setUserString(String& str) 		{userString = &str; return *this;}
@@ -187,20 +340,27 @@ public:
 	String 				getPayloadString();
 	bool   				feedString(String newString);
 	Commander&   	loadString(String newString);
+	bool   				stringOverflow() 												{return commandState.bit.stringOverflow;} //true if the last feedString() or loadString() was dropped because it didn't fit in the buffer
 	Commander&   	setPending(bool pState)									{commandState.bit.isCommandPending = pState; return *this;} //sets the pending command bit - used if manually writing to the buffer
-	Commander&	 	add(uint8_t character) 								{bufferString += character; return *this;}
+	Commander&	 	add(uint8_t character) 								{bufferString += (char)character; return *this;}
 	bool 	 				endLine();
-	Commander& 	 	startStreaming() 												{commandState.bit.dataStreamOn = true; return *this;} //set the streaming function ON
+	scriptResult_t runScript(Stream &source, bool stopOnError = false, uint16_t idleTimeout = 0); //run every line in source, without prompts or echo
+	Commander& 	 	startStreaming() 												{commandState.bit.dataStreamOn = true; if(streamBlock) streamBlock->length = 0; return *this;} //set the streaming function ON
 	Commander& 	 	stopStreaming() 												{commandState.bit.dataStreamOn = false; return *this;} //set the streaming function OFF
 	Commander& 	 	setStreaming(bool streamState) 					{commandState.bit.dataStreamOn = streamState; return *this;}
 	bool 	 				isStreaming() 													{return commandState.bit.dataStreamOn;}
 	Commander& 	 	setStreamingMode(bool dataStreamMode) 	{ports.settings.bit.dataStreamMode = dataStreamMode; return *this;}
 	bool 	 				getStreamingMode() 													{return ports.settings.bit.dataStreamMode;}
+	Commander& 	 	attachStreamHandler(streamHandler handler, uint16_t chunkSize = DEFAULT_STREAM_CHUNK); //stream data is passed to handler in chunks instead of the special handler
+	Commander& 	 	detachStreamHandler() 									{if(streamBlock) streamBlock->handler = NULL; return *this;}
+	uint16_t 	 		streamChunkSize() 											{return streamBlock ? streamBlock->chunk : 0;}
 	Commander&   	transfer(Commander& Cmdr);
 	bool   				transferTo(const commandList_t *commands, uint32_t size, String newName);
 	Commander&   	transferBack(const commandList_t *commands, uint32_t size, String newName);
+	bool   				transferTo(CommandTable& commands, String newName);
+	Commander&   	transferBack(CommandTable& commands, String newName);
 	Commander&   	attachOutputPort(Stream *oPort)							{ports.outPort = oPort; return *this;}
-	Stream* 			getOutputPort() 														{return ports.outPort;}
+	Stream* 			getOutputPort() 														{flushOutput(); drainQueue(true); return ports.outPort;}
 	Commander&   	attachAltPort(Stream *aPort)								{ports.altPort = aPort; return *this;} 
 	Stream* 			getAltPort() 																{return ports.altPort;}
 	//void detachAltPort()														{ports.altPort = NULL;}//ports.altPort->flush();
@@ -213,33 +373,55 @@ public:
 	Commander&   	setBuffer(uint16_t buffSize);
 	Commander&  	attachCommands(const commandList_t *commands, uint32_t size);
 	Commander&  	attachCommandArray(const commandList_t *commands, uint32_t length);
+	Commander&  	attachCommands(CommandTable& commands); //share a precomputed table with other Commander objects
+	CommandTable& getCommandTable() 													{return *table;}
+	Commander&  	attachOpcodes(OpcodeTable& opcodes) 			{opcodeTable = &opcodes; return *this;} //numbers at the start of a line are looked up in the opcode table
+	Commander&  	detachOpcodes() 													{opcodeTable = NULL; return *this;}
+	int32_t 			getOpcode(); //the opcode that called the handler
+	Commander&  	attachVariables(VariableTable& vars) 			{variableTable = &vars; watchCount = 0; return *this;} //enables the get, set, dump, watch and unwatch internal commands
+	Commander&  	detachVariables() 												{variableTable = NULL; watchCount = 0; return *this;}
+	Commander&  	printVariables(); //print name=value for every variable in the attached table
+	bool 					watchVariable(const char* name, uint16_t periodMs, bool onChange = false); //print the variable from update() every periodMs, at least MIN_WATCH_PERIOD
+	Commander&  	unwatchVariable(const char* name);
+	Commander&  	unwatchAll() 															{watchCount = 0; return *this;}
+	uint8_t 			watching() 																{return watchCount;} //number of variables being watched
 	Commander&   	setStreamType(streamType_t newType) 			{ports.settings.bit.streamType = (uint16_t)newType; return *this;}
 	streamType_t 	getStreamType() 													{return (streamType_t)ports.settings.bit.streamType;}
 	
-	Commander&    reloadCommands() 											  	{computeLengths(); return *this;}
+	Commander&    reloadCommands() 											  	{table->compute(); commandsChanged(); return *this;}
 	
-	int 	 				quick(String cmd);
+	//quickSet and quickGet look for an item in the payload that exactly matches cmd
+	int 	 				quick(const char* cmd);
 	Commander& 	 	quickSetHelp();
-	bool   				quickSet(String cmd, int& var);
-	bool   				quickSet(String cmd, float& var);
-	bool   				quickSet(String cmd, double& var);
-	bool 	 				quickSet(String cmd, String& str);
-	Commander&   	quickGet(String cmd, int var);
-	Commander&   	quickGet(String cmd, float var);
-	Commander&  	quickGet(String cmd, double var);
-	Commander& 	 	quickGet(String cmd, String str);
+	bool   				quickSet(const char* cmd, int& var);
+	bool   				quickSet(const char* cmd, float& var);
+	bool   				quickSet(const char* cmd, double& var);
+	bool 	 				quickSet(const char* cmd, String& str);
+	Commander&   	quickGet(const char* cmd, int var);
+	Commander&   	quickGet(const char* cmd, float var);
+	Commander&  	quickGet(const char* cmd, double var);
+	Commander& 	 	quickGet(const char* cmd, const String& str);
+	int 	 				quick(const String& cmd) 												{return quick(cmd.c_str());}
+	bool   				quickSet(const String& cmd, int& var) 					{return quickSet(cmd.c_str(), var);}
+	bool   				quickSet(const String& cmd, float& var) 				{return quickSet(cmd.c_str(), var);}
+	bool   				quickSet(const String& cmd, double& var) 				{return quickSet(cmd.c_str(), var);}
+	bool 	 				quickSet(const String& cmd, String& str) 				{return quickSet(cmd.c_str(), str);}
+	Commander&   	quickGet(const String& cmd, int var) 						{return quickGet(cmd.c_str(), var);}
+	Commander&   	quickGet(const String& cmd, float var) 					{return quickGet(cmd.c_str(), var);}
+	Commander&  	quickGet(const String& cmd, double var) 				{return quickGet(cmd.c_str(), var);}
+	Commander& 	 	quickGet(const String& cmd, const String& str) 	{return quickGet(cmd.c_str(), str);}
 		
-	size_t write(uint8_t b) {
-		yield();
-		if( ports.settings.bit.copyResponseToAlt ) writeAlt(b);
-		yield();
-		if(ports.outPort){ 
-				doPrefix();
-				if(isNewline(b)) ports.outPort->print(postfixString);
-			return ports.outPort->write(b); 
-		}
-		return 0;
-	}
+	size_t write(uint8_t b) 											{return write(&b, 1);}
+	size_t write(const uint8_t *buffer, size_t size);
+	//print a number with one write. Floats and doubles print the fewest digits that read back as the same value, unless decimals is given
+	Commander&  	printNumber(int value) 											{return printInteger(value);}
+	Commander&  	printNumber(long value) 										{return printInteger(value);}
+	Commander&  	printNumber(long long value) 								{return printInteger(value);}
+	Commander&  	printNumber(unsigned int value) 						{return printUnsigned(value);}
+	Commander&  	printNumber(unsigned long value) 						{return printUnsigned(value);}
+	Commander&  	printNumber(unsigned long long value) 			{return printUnsigned(value);}
+	Commander&  	printNumber(float value, int8_t decimals = NUMBER_SHORTEST);
+	Commander&  	printNumber(double value, int8_t decimals = NUMBER_SHORTEST);
 
 	int available() { return bufferString.length(); }
 
@@ -270,7 +452,7 @@ public:
 
 	//int availableForWrite() { return ports.outPort ? ports.outPort->availableForWrite() : 0; }
 
-	void flush() { if(ports.outPort) ports.outPort->flush(); }
+	void flush() { flushOutput(); drainQueue(true); if(ports.outPort) ports.outPort->flush(); }
 
 	using Print::write; // pull in write(String) and write(buf, size) from Print
 
@@ -317,9 +499,9 @@ public:
 	bool containsOn();
 	bool containsOff();
 	
-	Commander&  delimiters(String myDelims)				{ if(myDelims != "")	delimiterChars = myDelims; return *this;}
+	Commander&  delimiters(String myDelims)				{ if(myDelims != "")	delimiterChars = myDelims; buildDelimiterMap(); return *this;}
 	String 			delimiters()											{return delimiterChars;}
-	Commander& 	addDelimiter(char newDelim) 			{delimiterChars += newDelim; return *this;}
+	Commander& 	addDelimiter(char newDelim) 			{delimiterChars += newDelim; buildDelimiterMap(); return *this;}
 	
 	Commander&  commentChar(char cmtChar)     		{commentCharacter    = cmtChar; return *this;}
 	char 				commentChar()     								{return commentCharacter;}
@@ -329,6 +511,8 @@ public:
 	char 				endOfLineChar()     							{return endOfLineCharacter;}
 	Commander&  promptChar(char eol) 			    		{promptCharacter         = eol; return *this;}
 	char  			promptChar() 			    						{return promptCharacter;}
+	Commander&  separatorChar(char separator) 		{separatorCharacter = separator; return *this;} //separates commands on one line, EG ';' - 0 to disable
+	char  			separatorChar() 			    				{return separatorCharacter;}
 	//void setDelimChar(char eol) 			    {delimChar         = eol;}
 	
 	Commander& echo(bool sState) 								{ports.settings.bit.echoTerminal = sState; return *this;}
@@ -386,34 +570,94 @@ public:
 	Commander& printDelay(bool enable) 							{ports.settings.bit.useDelay = enable; return *this;}
 	bool printDelay() 															{return ports.settings.bit.useDelay;}
 	
+	Commander& bulkRead(bool state, uint16_t blockSize = DEFAULT_READ_BLOCK);
+	bool bulkRead() 																{return ports.settings.bit.bulkRead;}
+	
+	Commander& outputBuffer(bool state, uint16_t blockSize = DEFAULT_OUTPUT_BLOCK);
+	bool outputBuffer() 														{return ports.settings.bit.bufferOutput;}
+	
+	Commander& transmitQueue(bool state, uint16_t queueSize = DEFAULT_TX_QUEUE);
+	bool transmitQueue() 														{return ports.settings.bit.queueOutput;}
+	Commander& transmitPolicy(txPolicy_t policy) 		{ports.settings.bit.txPolicy = policy; return *this;}
+	txPolicy_t transmitPolicy() 										{return (txPolicy_t)ports.settings.bit.txPolicy;}
+	uint16_t transmitPending() 											{return txQueue ? txQueue->count : 0;} //bytes waiting in the transmit queue
+	uint32_t droppedBytes() 												{return txQueue ? txQueue->dropped : 0;}
+	Commander& resetDroppedBytes() 									{if(txQueue) txQueue->dropped = 0; return *this;}
+	
+	Commander& binaryFrames(bool state, uint8_t replyBytes = DEFAULT_FRAME_REPLY);
+	bool binaryFrames() 														{return ports.settings.bit.binaryFrames;}
+	bool isBinaryFrame() 														{return commandState.bit.binaryFrame;} //true if the handler was called by a binary frame
+	uint8_t frameArgsLeft() 												{return commandState.bit.binaryFrame ? frameState->end - frameState->read : 0;} //argument bytes left to read in a binary frame
+	template <class vType>
+	bool getBinary(vType &value)	{
+		//read the next argument from a binary frame. Arduino boards are little endian so the bytes are copied as they are
+		return getBinary((uint8_t*)&value, sizeof(vType));
+	}
+	bool getBinary(uint8_t *data, uint8_t length);
+	template <class vType>
+	Commander& putBinary(vType value)	{
+		//add a value to the reply frame
+		return putBinary((const uint8_t*)&value, sizeof(vType));
+	}
+	Commander& putBinary(const uint8_t *data, uint8_t length);
+	
+	Commander& commandStats(bool state);
+	bool commandStats() 														{return ports.settings.bit.commandStats;}
+	Commander& resetCommandStats();
+	const cmdStats_t* getCommandStats(uint16_t commandIndex); //stats for an entry in the command list, NULL if stats are disabled
+	Commander& printCommandStats();
+	
 	Commander& printDiagnostics();
 
 	template <class iType>
 	bool getInt(iType &myIvar)	{ 
-		if(tryGet()){
-			//Parse it to the variable
-			String subStr = bufferString.substring(dataReadIndex);
-			myIvar = (iType)subStr.toInt();
-			//if there is no space next, set dataReadIndex to zero and return true - you parsed an int, but next time it will fail.
-			if(!findNextItem()) dataReadIndex = 0;//nextNumberDelimiter();
-			return true; //nextSpace();
-		}else return 0;
+		int64_t value = 0;
+		if(!getInteger(value)) return 0;
+		myIvar = clampInt<iType>(value, parseStatus);
+		return true;
+	}
+	template <class iType>
+	uint16_t getInts(iType *values, uint16_t maxValues, int16_t *badItem = NULL)	{
+		//Parse up to maxValues ints from the payload into values[], stopping at the first item that isn't a clean number
+		uint16_t count = 0;
+		while(count < maxValues){
+			const char* start = numberStart(badItem);
+			if(start == NULL) break;
+			int64_t value = 0;
+			uint8_t status = PARSE_OK;
+			const char* end = parseInteger(start, value, status, parseOptions());
+			iType item = clampInt<iType>(value, status);
+			if(!numberDone(end, status, badItem)) break;
+			values[count++] = item;
+		}
+		return count;
 	}
+	uint16_t getFloats(float *values, uint16_t maxValues, int16_t *badItem = NULL); //Parse up to maxValues floats into values[] and return how many were read
+	uint16_t getDoubles(double *values, uint16_t maxValues, int16_t *badItem = NULL); //Parse up to maxValues doubles into values[] and return how many were read
 	bool getFloat(float &myFloat);  //Returns true if myFloat was updated with a value parsed from the command String
 	bool getDouble(double &myDouble);  //Returns true if myDouble was updated with a value parsed from the command String
+	bool getFixed(int32_t &myFixed, uint8_t decimals);  //Returns true if myFixed was updated with a value scaled by 10^decimals (EG 1.25 with 2 decimals is 125)
+	uint8_t parseError() 												{return parseStatus;} //PARSE_OK or the error from the last getInt, getFloat, getDouble or getFixed
+	uint16_t parseEnd() 												{return parseEndIndex;} //index in the buffer where the last number ended
+	Commander& engineeringSuffixes(bool state) 			{ports.settings.bit.engineeringSuffixes = state; return *this;} //accept 1.5k, 10m etc. when parsing numbers
+	bool engineeringSuffixes() 											{return ports.settings.bit.engineeringSuffixes;}
 	bool getString(String &myString); //returns the next string in the payload - determined by the delimiters space and special char
 	uint8_t countItems(); //Returns the number of items in the payload. An item is any string with a space or delimiterChar at each end (or the end of line)
-	uint16_t getCommandListLength() {return commandListEntries;} //returns the number of commands
-	const commandList_t* getCommandList() {return commandList;}
+	uint16_t getCommandListLength() {return table->commandListEntries;} //returns the number of commands
+	const commandList_t* getCommandList() {return table->commandList;}
 	String 	getCommandItem(uint16_t commandItem); //returns a String containing the specified command and help text
 	uint8_t getInternalCommandLength() {return INTERNAL_COMMAND_ITEMS;}
 	String getInternalCommandItem(uint8_t internalItem);
 	uint16_t getReadIndex() {return dataReadIndex;}
+	uint8_t getItemCount() 											{return commandState.bit.itemsValid ? itemCount : 0;} //number of items in the item table
+	Commander& itemTable(uint8_t size); //items this object can hold in its item table, 0 to always search the buffer. COMMANDER_MAX_ITEMS by default
+	uint8_t itemTable() 												{return itemCapacity;}
+	cmdItem_t getItem(uint8_t itemIndex); //position of an item in the buffer
 	Commander& rewind();
 	Commander& printCommandList();
 	Commander& printCommanderVersion();
 	int16_t getCommandIndex()										{return commandIndex;}
-	String bufferString = ""; //the buffer - public so user functions can read it
+	CommandBuffer bufferString; //the buffer - public so user functions can read it. Fixed size, set with setBuffer() or the constructor
 	String commanderName = "CMD";
 	
 	#if defined BENCHMARKING_ON
@@ -424,22 +668,50 @@ public:
 	
 private:
 	bool processPending();
+	bool terminateBuffer();
+	bool loadBuffer(const String& newString);
+	void copyItem(String &myString, uint16_t start, uint16_t end);
+	bool updateOnce();
+	void handleChain();
+	void splitChain();
+	void nextChainSegment();
 	bool streamData();
+	bool streamBlocks();
+	bool runScriptLine(scriptResult_t &result, bool stopOnError);
+	void passStreamChunk();
+	void readBlocks();
+	bool inputAvailable();
+	int  readInput();
+	int  peekInput();
 	void echoPorts(int portByte);
+	void echoPorts(const uint8_t* portData, size_t length);
+	bool isFrameByte(int dataByte){ //true if the byte is part of a binary frame, or starts one, so it shouldn't be echoed
+		return commandState.bit.frameReceiving || (dataByte == FRAME_START && ports.settings.bit.binaryFrames && commandState.bit.bufferState == BUFFER_WAITING_FOR_START);
+	}
 	void bridgePorts();
 		void doPrefix(){ //handle prefixes for command replies
-			if(commandState.bit.prefixMessage && commandState.bit.newlinePrinted) ports.outPort->print(prefixString); 
+			if(commandState.bit.prefixMessage && commandState.bit.newlinePrinted) sendOut(prefixString); 
 			commandState.bit.newlinePrinted = false;
 		}
 		void doPrefixln(){ //handle prefixes for command replies with newlines
 			if( ports.settings.bit.useDelay ) delay(primntDelayTime);
-			if(commandState.bit.prefixMessage && commandState.bit.newlinePrinted) ports.outPort->print(prefixString); 
+			if(commandState.bit.prefixMessage && commandState.bit.newlinePrinted) sendOut(prefixString); 
 			commandState.bit.newlinePrinted = true;
 		}
-	bool qSetHelp(String &cmd);
-	int qSetSearch(String &cmd);
-	void computeLengths();
-	uint8_t getLength(uint8_t indx);
+	void sendOut(const uint8_t* data, size_t length);
+	void sendOut(const String &str) 	{sendOut((const uint8_t*)str.c_str(), str.length());}
+	void flushOutput();
+	void transmit(const uint8_t* data, size_t length);
+	void drainQueue(bool all);
+	bool qSetHelp(const char* cmd);
+	int qSetSearch(const char* cmd);
+	bool qGetSearch(const char* cmd);
+	int findKey(const char* key, uint16_t keyLength);
+	bool keyMatches(uint16_t start, const char* key, uint16_t keyLength);
+	void commandsChanged();
+	bool transferPayload(String& newName);
+	void startTracking();
+	void trackCommand(char dataByte);
 	bool handleCommand();
 	bool handleUnknown();
 	void tryUnlock();
@@ -452,19 +724,63 @@ private:
 	bool checkCommand(uint16_t cmdIdx);
 	bool checkInternalCommand(uint16_t cmdIdx);
 	bool qcheckInternal(uint8_t itm);
+	void recordStats(uint16_t cmdIdx, uint32_t handlerTime);
+	void selectStats();
+	void freeStats();
+	bool callHandler(uint16_t cmdIdx);
 	int  handleInternalCommand(uint16_t internalCommandIndex);
 	bool handleCustomCommand();
+	bool frameByte(int dataByte);
+	bool handleFrame();
+	void sendFrame(uint8_t commandID, const uint8_t* data, uint8_t length);
+	void frameError(uint8_t code, uint8_t commandID);
 	bool tryGet();
+	bool getInteger(int64_t &myInt);
+	uint8_t parseOptions() 																		{return ports.settings.bit.engineeringSuffixes ? PARSE_SUFFIXES : PARSE_DEFAULT;}
+	template <class iType>
+	static iType clampInt(int64_t value, uint8_t &status){
+		//values that don't fit the type are clamped to its largest or smallest value and flagged as an overflow
+		bool isSigned = (iType)(-1) < (iType)0;
+		uint8_t bits = sizeof(iType) * 8;
+		int64_t highest = isSigned ? (int64_t)((1ULL << (bits - 1)) - 1) : (bits >= 64 ? 0x7FFFFFFFFFFFFFFFLL : (int64_t)((1ULL << bits) - 1));
+		int64_t lowest = isSigned ? -highest - 1 : 0;
+		if(value <= highest && value >= lowest) return (iType)value;
+		if(status == PARSE_OK || status == PARSE_TRAILING) status = PARSE_OVERFLOW;
+		return value > highest ? (iType)highest : (iType)lowest;
+	}
+	void numberParsed(const char* end, uint8_t status);
+	const char* numberStart(int16_t *badItem);
+	bool numberDone(const char* end, uint8_t status, int16_t *badItem);
 	bool findNextDelim();
 	bool findNextItem();
+	void splitItems();
+	bool syncItem();
+	bool nextItem();
 	bool delimToNextItem();
 	bool itemToNextDelim();
-	bool isDelimiter(char ch);
+	void buildDelimiterMap();
+	bool useOwnTable();
+	bool isDelimiter(char ch)						{return delimiterMap[(uint8_t)ch >> 3] & (1 << ((uint8_t)ch & 7));}
 	bool isItem(char ch);
-	bool isNumber(String &str);
+	bool isNumber(const CommandBuffer &str);
+	bool matchOpcode();
+	bool checkVariableCommand(uint16_t cmdIdx);
+	int  variableAtCursor();
+	bool setVariable(uint8_t idx);
+	void printVariable(uint8_t idx);
+	void printValue(uint8_t idx);
+	Commander& printInteger(int64_t value);
+	Commander& printUnsigned(uint64_t value);
+	void watchVariables();
+	void unwatchVariables();
+	bool addWatch(uint8_t idx, uint16_t periodMs, bool onChange);
+	void removeWatch(uint8_t idx);
+	void serviceWatches();
+	void setVariables();
+	void getVariables();
 	bool isNumeral(char ch);
-	bool isEndOfLine(char dataByte);
-	bool isEndOfCommand(char dataByte);
+	bool isEndOfLine(char dataByte)				{return dataByte == endOfLineCharacter;}
+	bool isEndOfCommand(char dataByte)		{return isEndOfLine(dataByte) || isDelimiter(dataByte);}
 	//bool isStartOfItem(char dataByte);
 	bool isNewline(char var) {		return (var == '\n') ? true : false;}
 	bool isNewline(int var) {			return (var == '\n') ? true : false;}
@@ -481,30 +797,53 @@ private:
 	}
 	String prefixString = "";
 	String postfixString = "";
-	const commandList_t* commandList;
-	uint8_t commandListEntries = 0;
-  cmdHandler customHandler;
-  cmdHandler defaultHandler;
+	CommandTable* ownTable = NULL; //used when a command list is attached directly, allocated the first time one is
+	CommandTable* table = &noCommands; //the table in use, either ownTable or one shared with other Commander objects
+	static CommandTable noCommands; //empty table for objects that haven't had any commands attached
+	OpcodeTable* opcodeTable = NULL; //numeric commands, if attached
+	VariableTable* variableTable = NULL; //variables for the get, set and dump commands, if attached
+	watch_t* watchList = NULL; //variables that are printed from update(), allocated when the first one is watched
+	uint8_t watchCount = 0;
+  cmdHandler customHandler = NULL;
+  cmdHandler defaultHandler = NULL;
 	cmdState_t commandState;
 	portSettings_t ports;
   //int8_t commandType = UNKNOWN_COMMAND;
   int16_t commandIndex = -1;
-	uint8_t* commandLengths;
+	uint8_t matchLo = 0; //range of commandOrder entries that still match the bytes written to the buffer
+	uint8_t matchHi = 0;
+	uint16_t matchPos = 0; //number of bytes checked by trackCommand()
+	int16_t matchIndex = -1; //longest command matched so far by trackCommand()
 	uint8_t endIndexOfLastCommand = 0;
-	const char** extraHelp;
-	uint8_t longestCommand = 0;
+	const char** extraHelp = NULL;
 	char commentCharacter = '#'; //marks a line as a comment - ignored by the command parser
 	char reloadCommandCharacter = '/'; //send this character to automatically reprocess the old buffer - same as resending the last command from the users POV.	
 	char promptCharacter = '>';
+	char separatorCharacter = 0; //splits a line into separate commands, disabled when 0
+	uint16_t chainEnd = 0; //start of the next command after a separator, 0 if there isn't one
 	//char* delimiters;
-	String delimiterChars = "= :,\t\\/|";
+	String delimiterChars = DEFAULT_DELIMITERS;
+	uint8_t* delimiterMap = NULL; //one bit per char value, set when the char is a delimiter. Shared by every object using the default delimiters
 	//char delimChar = '='; //special delimiter character - Is used IN ADDITION to the default space char to mark the end of a command or seperation between items
 	char endOfLineCharacter = '\n';
   uint16_t bytesWritten = 0; //overflow check for bytes written into the buffer
 	uint16_t bufferSize = SBUFFER_DEFAULT;
 	uint16_t dataReadIndex = 0; //for parsing many numbers
-	//const char* internalCommandArray[INTERNAL_COMMAND_ITEMS];
-	const char* internalCommandArray[INTERNAL_COMMAND_ITEMS] = { "U", "X", "?", "help", "echo", "echox", "errors"};
+	uint8_t parseStatus = PARSE_OK; //result of the last number parsed
+	uint16_t parseEndIndex = 0; //where the last number parsed ended
+	cmdItem_t* items = NULL; //the items in the payload, found once per command
+	uint8_t itemCapacity = 0;
+	uint8_t itemCount = 0;
+	uint8_t itemIndex = 0; //the item at dataReadIndex
+	readBlock_t* readBlock = NULL; //block of incoming data when bulkRead is enabled
+	cmdStatsBlock_t* statsBlocks = NULL; //stats for each command list that has been used while commandStats is enabled
+	cmdStatsBlock_t* statsCurrent = NULL; //the stats for the current command list
+	outBlock_t* outBlock = NULL; //replies waiting to be written to the out port when bufferOutput is enabled
+	txQueue_t* txQueue = NULL; //data for the out port when queueOutput is enabled
+	streamBlock_t* streamBlock = NULL; //stream data for the stream handler, if one is attached
+	uint16_t commandCount = 0; //commands handled since the start of the last update
+	frameState_t* frameState = NULL; //binary frame state when binaryFrames is enabled
+	static const char* const internalCommandArray[INTERNAL_COMMAND_ITEMS]; //shared by every Commander object
 	String *passPhrase = NULL;
 	String *userString = NULL;
 	uint8_t primntDelayTime = 0; //
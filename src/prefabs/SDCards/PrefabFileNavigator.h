@@ -14,6 +14,27 @@ File file1, file2;
 bool fileOpen = false; //indicates if a file is open
 extern String cmdName;
 
+//Files are read and written a block at a time. 512 bytes is one SD card sector, so whole blocks don't need a read-modify-write on the card
+#ifndef FILE_BLOCK_SIZE
+	#if defined(__AVR__)
+		#define FILE_BLOCK_SIZE 64
+	#else
+		#define FILE_BLOCK_SIZE 512
+	#endif
+#endif
+uint8_t fileBlock[FILE_BLOCK_SIZE];
+
+//When data sent with the write command is synced to the card
+typedef enum fileSync_t{
+	SYNC_EACH_WRITE = 0, //sync after every chunk - safest, but much slower
+	SYNC_PERIODIC 	= 1, //sync when fileSyncInterval milliseconds have passed since the last sync
+	SYNC_ON_CLOSE 	= 2, //only sync when the file is closed
+} fileSync_t;
+fileSync_t fileSyncPolicy = SYNC_PERIODIC;
+uint32_t fileSyncInterval = 1000;
+uint32_t lastFileSync = 0;
+bool fileWriteEcho = false; //print each chunk that is written to the file
+
 const commandList_t* topLayerCommands;
 uint16_t topLayerCommandSize = 0;
 String topPrompt = "";
@@ -36,6 +57,33 @@ void closeFiles(){
 }
 //-----------------------------------------------------------------------------------------------
 
+void setFileSync(fileSync_t policy, uint32_t interval = 1000){
+	fileSyncPolicy = policy;
+	fileSyncInterval = interval;
+}
+//-----------------------------------------------------------------------------------------------
+
+void setFileWriteEcho(bool state){
+	fileWriteEcho = state;
+}
+//-----------------------------------------------------------------------------------------------
+
+//write data to file1, echo it if enabled and sync it according to the sync policy
+void writeFileData(Commander &Cmdr, const uint8_t* data, size_t length){
+	if(length == 0) return;
+	if(fileWriteEcho){
+		Cmdr.print("WRITING:");
+		Cmdr.write(data, length);
+		Cmdr.println();
+	}
+	file1.write(data, length);
+	if(fileSyncPolicy == SYNC_EACH_WRITE || (fileSyncPolicy == SYNC_PERIODIC && millis() - lastFileSync >= fileSyncInterval)){
+		file1.flush();
+		lastFileSync = millis();
+	}
+}
+//-----------------------------------------------------------------------------------------------
+
 void setTopLayer(const commandList_t* topCommands, uint16_t sizes, String prompt){
 	topLayerCommands = topCommands;
 	topLayerCommandSize = sizes;
@@ -135,8 +183,9 @@ bool readFileContents(Commander &Cmdr){
 	}
 	Cmdr.print("Reading from file ");
 	Cmdr.println(Cmdr.getPayloadString());
-  while(tmpFile.available()){
-    Cmdr.write(tmpFile.read());
+  int bytesRead;
+  while((bytesRead = tmpFile.read(fileBlock, FILE_BLOCK_SIZE)) > 0){
+    Cmdr.write(fileBlock, bytesRead);
   }
   Cmdr.write('\n');
   tmpFile.close();
@@ -154,6 +203,7 @@ bool writeToFileHandler(Commander &Cmdr){
 		file1 = SD.open(Cmdr.getPayloadString().c_str(), O_WRITE | O_CREAT);
 		Cmdr.print(F("Created file: "));
 		Cmdr.println(Cmdr.getPayloadString());
+		lastFileSync = millis();
 		Cmdr.startStreaming();
 	}else Cmdr.print(F("Error - Filename required"));
   return 0;
@@ -179,13 +229,7 @@ bool streamToFileHandler(Commander &Cmdr){
 		Cmdr.stopStreaming();
 		return 0;
 	}
-	if(Cmdr.bufferString.length() > 0){
-		//write to the file and flush the buffer.
-		Cmdr.print("WRITING:");
-		Cmdr.println(Cmdr.bufferString);
-		file1.print(Cmdr.bufferString);
-		file1.flush();
-	}
+	writeFileData(Cmdr, (const uint8_t*)Cmdr.bufferString.c_str(), Cmdr.bufferString.length());
 	if(Cmdr.isStreaming() == false && file1.isOpen()){
 		//File is open but streaming has stopped - indicated end of file and time to tidy up.
 		Cmdr.println("Flushing and closing file");
@@ -196,6 +240,24 @@ bool streamToFileHandler(Commander &Cmdr){
 	return 0;
 }
 //-----------------------------------------------------------------------------------------------
+bool streamToFileBlocks(Commander &Cmdr, const uint8_t* data, size_t length){
+	//Block stream handler for file writes - attach it with Cmdr.attachStreamHandler(streamToFileBlocks, FILE_BLOCK_SIZE)
+	//While data is arriving it is passed in whole blocks, so the writes line up with the card sectors
+	if(!file1.isOpen()){
+		Cmdr.println("Error: Streaming to closed file");
+		Cmdr.stopStreaming();
+		return 0;
+	}
+	writeFileData(Cmdr, data, length);
+	if(Cmdr.isStreaming() == false){
+		//end of file - time to tidy up.
+		Cmdr.println("Flushing and closing file");
+		file1.flush();
+		file1.close();
+	}
+	return 0;
+}
+//-----------------------------------------------------------------------------------------------
 
 
 //All commands for 'master'
@@ -0,0 +1,98 @@
+//Fixed size big integer for Commander's number formatting and parsing
+/*
+An unsigned integer of up to WORDS 32 bit words, with only the operations that exact float and double conversions need.
+NumberFormat uses it to generate the shortest digits of a value, and NumberParser uses it to decide which way a decimal
+rounds when the quick conversion can't be sure. Nothing is allocated, the caller picks WORDS to fit the largest value.
+*/
+#ifndef BigNum_h
+#define BigNum_h
+
+#include <Arduino.h>
+#include <string.h>
+
+template <uint8_t WORDS>
+struct bigNum_t{
+	uint32_t word[WORDS];
+	uint8_t length; //words in use, the rest are not valid
+
+	void set(uint64_t value){
+		length = 0;
+		while(value){
+			word[length++] = (uint32_t)value;
+			value >>= 32;
+		}
+	}
+	void multiply(uint32_t factor, uint32_t addend = 0){
+		//this = this * factor + addend
+		uint32_t carry = addend;
+		for(uint8_t n = 0; n < length; n++){
+			uint64_t product = (uint64_t)word[n] * factor + carry;
+			word[n] = (uint32_t)product;
+			carry = (uint32_t)(product >> 32);
+		}
+		if(carry) word[length++] = carry;
+	}
+	void multiplyPow10(uint16_t exponent){
+		for(; exponent >= 9; exponent -= 9) multiply(1000000000UL);
+		uint32_t factor = 1;
+		while(exponent--) factor *= 10;
+		if(factor > 1) multiply(factor);
+	}
+	void multiplyPow5(uint16_t exponent){
+		for(; exponent >= 13; exponent -= 13) multiply(1220703125UL);
+		uint32_t factor = 1;
+		while(exponent--) factor *= 5;
+		if(factor > 1) multiply(factor);
+	}
+	void shiftLeft(uint16_t bits){
+		if(length == 0) return;
+		uint8_t words = bits / 32;
+		bits %= 32;
+		if(bits){
+			uint32_t carry = 0;
+			for(uint8_t n = 0; n < length; n++){
+				uint32_t next = word[n] >> (32 - bits);
+				word[n] = (word[n] << bits) | carry;
+				carry = next;
+			}
+			if(carry) word[length++] = carry;
+		}
+		if(words){
+			for(int16_t n = length - 1; n >= 0; n--) word[n + words] = word[n];
+			memset(word, 0, words * sizeof(uint32_t));
+			length += words;
+		}
+	}
+	void add(const bigNum_t &a, const bigNum_t &b){
+		//this = a + b
+		const bigNum_t &longer = a.length >= b.length ? a : b;
+		const bigNum_t &shorter = a.length >= b.length ? b : a;
+		uint32_t carry = 0;
+		for(uint8_t n = 0; n < longer.length; n++){
+			uint64_t sum = (uint64_t)longer.word[n] + (n < shorter.length ? shorter.word[n] : 0) + carry;
+			word[n] = (uint32_t)sum;
+			carry = (uint32_t)(sum >> 32);
+		}
+		length = longer.length;
+		if(carry) word[length++] = carry;
+	}
+	void subtract(const bigNum_t &b){
+		//this -= b, this must not be smaller than b
+		uint32_t borrow = 0;
+		for(uint8_t n = 0; n < length; n++){
+			uint64_t difference = (uint64_t)word[n] - (n < b.length ? b.word[n] : 0) - borrow;
+			word[n] = (uint32_t)difference;
+			borrow = (difference >> 32) ? 1 : 0;
+		}
+		while(length && word[length-1] == 0) length--;
+	}
+	int8_t compare(const bigNum_t &b) const{
+		if(length != b.length) return length < b.length ? -1 : 1;
+		for(int16_t n = length - 1; n >= 0; n--){
+			if(word[n] != b.word[n]) return word[n] < b.word[n] ? -1 : 1;
+		}
+		return 0;
+	}
+};
+
+#endif //BigNum_h
@@ -0,0 +1,14 @@
+#include "BinaryFrame.h"
+
+//==============================================================================================================
+uint16_t frameCRC(uint16_t crc, const uint8_t* data, size_t length){
+	//CRC-16/CCITT-FALSE (polynomial 0x1021), computed a bit at a time so it doesn't need a lookup table in flash
+	while(length--){
+		crc ^= (uint16_t)(*data++) << 8;
+		for(uint8_t n = 0; n < 8; n++){
+			if(crc & 0x8000) crc = (crc << 1) ^ 0x1021;
+			else crc <<= 1;
+		}
+	}
+	return crc;
+}
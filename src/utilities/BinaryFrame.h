@@ -0,0 +1,39 @@
+//Binary frames for Commander
+/*
+A compact framed format that can be used on the same port as the text protocol once binaryFrames() is enabled.
+A frame is recognised by its start byte when Commander is waiting for the start of a line, so text commands and
+frames can be mixed freely.
+
+Frame layout (request and reply):
+	byte 0				FRAME_START
+	byte 1				length of the arguments (0 - 255)
+	byte 2				command ID - the index of the command in the command list
+	bytes 3...		arguments, multi byte values are little endian
+	last 2 bytes	CRC-16/CCITT-FALSE of bytes 1 to the end of the arguments, low byte first
+
+A request can name the command instead of using its index by setting the command ID to FRAME_NAMED, and starting
+the arguments with the command string and a null. Replies always carry the index so the host can use it next time.
+If a frame can't be handled the reply has the ID FRAME_ERROR and two argument bytes: the error code and the ID
+from the request.
+*/
+#ifndef BinaryFrame_h
+#define BinaryFrame_h
+
+#include <Arduino.h>
+
+#define FRAME_START 					0xA5
+#define FRAME_NAMED 					0xFE //the arguments start with a null terminated command string
+#define FRAME_ERROR 					0xFF //reply to a frame that could not be handled
+#define FRAME_HEADER_LENGTH 	3
+#define FRAME_CRC_LENGTH 			2
+#define FRAME_CRC_INIT 				0xFFFF
+
+//error codes sent in FRAME_ERROR replies
+#define FRAME_ERR_CRC 				1 //the CRC did not match
+#define FRAME_ERR_LENGTH 			2 //the frame was too long for the command buffer
+#define FRAME_ERR_UNKNOWN 		3 //there is no command with that ID or name
+#define FRAME_ERR_LOCKED 			4 //Commander is locked
+
+uint16_t frameCRC(uint16_t crc, const uint8_t* data, size_t length);
+
+#endif //BinaryFrame_h
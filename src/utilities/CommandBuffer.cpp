@@ -0,0 +1,117 @@
+#include "CommandBuffer.h"
+
+bool CommandBuffer::setCapacity(uint16_t size){
+	//(re)allocate the storage - this is the only place the buffer uses the heap
+	if(data && size == bufferCapacity){
+		clear();
+		return true;
+	}
+	if(data) delete [] data;
+	data = new char[size+1];
+	bufferCapacity = data ? size : 0;
+	clear();
+	return data != NULL;
+}
+//==============================================================================================================
+void CommandBuffer::clear(){
+	head = 0;
+	tail = 0;
+	if(data) data[0] = '\0';
+}
+//==============================================================================================================
+bool CommandBuffer::concat(char c){
+	if(head > 0 && tail >= bufferCapacity) compact();
+	if(tail >= bufferCapacity) return false;
+	data[tail++] = c;
+	data[tail] = '\0';
+	return true;
+}
+//==============================================================================================================
+bool CommandBuffer::concat(const char* str, unsigned int len){
+	//append as much of str as will fit, returns false if it was truncated
+	if(head > 0 && tail + len > bufferCapacity) compact();
+	bool fits = true;
+	if(tail + len > bufferCapacity){
+		len = bufferCapacity - tail;
+		fits = false;
+	}
+	if(len) memmove(&data[tail], str, len);
+	tail += len;
+	if(data) data[tail] = '\0';
+	return fits;
+}
+//==============================================================================================================
+void CommandBuffer::compact(){
+	//move the contents back to the start to make room at the end
+	memmove(data, &data[head], tail - head);
+	tail -= head;
+	head = 0;
+	data[tail] = '\0';
+}
+//==============================================================================================================
+CommandBuffer& CommandBuffer::operator = (const char* str){
+	//copy str into the buffer. str may point into the buffer itself, so move rather than copy
+	unsigned int len = strlen(str);
+	if(len > bufferCapacity) len = bufferCapacity;
+	if(len) memmove(data, str, len);
+	head = 0;
+	tail = len;
+	if(data) data[tail] = '\0';
+	return *this;
+}
+//==============================================================================================================
+void CommandBuffer::remove(unsigned int index){
+	//remove everything from index to the end
+	if(index >= length()) return;
+	tail = head + index;
+	data[tail] = '\0';
+}
+//==============================================================================================================
+void CommandBuffer::remove(unsigned int index, unsigned int count){
+	if(index >= length()) return;
+	if(count > length() - index) count = length() - index;
+	if(index == 0){
+		//removing from the front just moves the head
+		head += count;
+		if(head == tail) clear();
+		return;
+	}
+	memmove(&data[head+index], &data[head+index+count], tail - (head+index+count) + 1);
+	tail -= count;
+}
+//==============================================================================================================
+int CommandBuffer::indexOf(char c, unsigned int fromIndex) const{
+	if(fromIndex >= length()) return -1;
+	const char* found = (const char*)memchr(&data[head+fromIndex], c, length() - fromIndex);
+	if(found == NULL) return -1;
+	return found - &data[head];
+}
+//==============================================================================================================
+int CommandBuffer::indexOf(const char* str, unsigned int fromIndex) const{
+	if(fromIndex >= length()) return -1;
+	const char* found = strstr(&data[head+fromIndex], str);
+	if(found == NULL) return -1;
+	return found - &data[head];
+}
+//==============================================================================================================
+String CommandBuffer::substring(unsigned int beginIndex, unsigned int endIndex) const{
+	if(beginIndex > endIndex){
+		unsigned int tmp = endIndex;
+		endIndex = beginIndex;
+		beginIndex = tmp;
+	}
+	if(beginIndex >= length()) return String("");
+	if(endIndex > length()) endIndex = length();
+	//terminate the substring in place while it is copied
+	char* end = &data[head+endIndex];
+	char saved = *end;
+	*end = '\0';
+	String subString(&data[head+beginIndex]);
+	*end = saved;
+	return subString;
+}
+//==============================================================================================================
+size_t CommandBuffer::printTo(Print& p) const{
+	if(!length()) return 0;
+	return p.write((const uint8_t*)&data[head], length());
+}
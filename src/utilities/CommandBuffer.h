@@ -0,0 +1,59 @@
+//Fixed capacity command buffer for Commander
+/*
+The buffer is allocated once (by the Commander constructor or setBuffer()) and never grows, so reading, writing and
+parsing commands does not touch the heap.
+Data is stored between a head and a tail index and is always null terminated. Removing characters from the front
+(reading a byte, or dropping a command that has been handled when chaining) just moves the head, and the head
+returns to the start of the storage whenever the buffer is cleared, or when adding to it needs the room at the front.
+
+The methods mirror the parts of the Arduino String class that sketches use with Commander.bufferString, so existing
+code like Cmdr.print(Cmdr.bufferString) or Cmdr.bufferString.length() still works. Only substring() and conversion
+to a String create a String object.
+*/
+#ifndef CommandBuffer_h
+#define CommandBuffer_h
+
+#include <Arduino.h>
+#include <string.h>
+
+class CommandBuffer : public Printable {
+public:
+	CommandBuffer() {}
+	~CommandBuffer()																{ if(data) delete [] data; }
+	bool 					setCapacity(uint16_t size);
+	uint16_t 			capacity() const 									{return bufferCapacity;}
+	unsigned int 	length() const 										{return tail - head;}
+	bool 					isFull() const 										{return tail >= bufferCapacity;}
+	const char* 	c_str() const 										{return data ? &data[head] : "";}
+	char 					charAt(unsigned int index) const	{return (index < length()) ? data[head+index] : '\0';}
+	char 					operator [](unsigned int index) const	{return charAt(index);}
+	void 					setCharAt(unsigned int index, char c) {if(index < length()) data[head+index] = c;}
+	void 					clear();
+	bool 					concat(char c);
+	bool 					concat(const char* str, unsigned int len);
+	CommandBuffer& operator = (const char* str);
+	CommandBuffer& operator = (const String& str)	{return *this = str.c_str();}
+	CommandBuffer& operator += (char c)						{concat(c); return *this;}
+	CommandBuffer& operator += (const char* str)		{concat(str, strlen(str)); return *this;}
+	CommandBuffer& operator += (const String& str)	{concat(str.c_str(), str.length()); return *this;}
+	void 					remove(unsigned int index);
+	void 					remove(unsigned int index, unsigned int count);
+	int 					indexOf(char c, unsigned int fromIndex = 0) const;
+	int 					indexOf(const char* str, unsigned int fromIndex = 0) const;
+	int 					indexOf(const String& str, unsigned int fromIndex = 0) const {return indexOf(str.c_str(), fromIndex);}
+	String 				substring(unsigned int beginIndex) const {return substring(beginIndex, length());}
+	String 				substring(unsigned int beginIndex, unsigned int endIndex) const;
+	String 				toString() const 									{return String(c_str());}
+	operator 			String() const 										{return toString();}
+	size_t 				printTo(Print& p) const;
+private:
+	CommandBuffer(const CommandBuffer&);
+	CommandBuffer& operator = (const CommandBuffer&);
+	void 					compact();
+	char* data = NULL;
+	uint16_t bufferCapacity = 0;
+	uint16_t head = 0;
+	uint16_t tail = 0;
+};
+
+#endif //CommandBuffer_h
@@ -0,0 +1,88 @@
+#include "CommandTable.h"
+
+CommandTable::~CommandTable(){
+	//commandOrder is part of the same allocation
+	if(commandLengths) delete [] commandLengths;
+}
+//==============================================================================================================
+CommandTable& CommandTable::attach(const commandList_t *commands, uint32_t size){
+	return attachArray(commands, size / sizeof(commandList_t)); //size is the size of the whole array, not the individual entries
+}
+//==============================================================================================================
+CommandTable& CommandTable::attachArray(const commandList_t *commands, uint32_t length){
+	commandList = commands;
+	commandListEntries = length;
+	return compute();
+}
+//==============================================================================================================
+CommandTable& CommandTable::compute(){
+	//compute the length of each command and the sorted index
+	if(commandListEntries == 0) return *this;
+	//the lengths and the index share one allocation, which is only replaced if the new list is bigger
+	if(commandListEntries > tableCapacity){
+		if(commandLengths) delete [] commandLengths;
+		commandLengths = new uint8_t[commandListEntries * 2];
+		tableCapacity = commandListEntries;
+	}
+	commandOrder = &commandLengths[tableCapacity];
+	longestCommand = 0;
+	for(int n = 0; n < commandListEntries; n++){
+		commandLengths[n] = getLength(n);
+		if(commandLengths[n] > longestCommand) longestCommand = commandLengths[n];
+	}
+	sortCommands();
+	return *this;
+}
+//==============================================================================================================
+uint8_t CommandTable::getLength(uint8_t index) const{
+	uint8_t length = 0;
+	for(uint8_t n = 0; n < 128; n++){
+		if(commandList[index].commandString[n] != '\0') length++;
+		else return length;
+	}
+	//Should this return zero if max length is reached ...?
+	return length;
+}
+//==============================================================================================================
+void CommandTable::sortCommands(){
+	//build an index of the command list sorted by command string so commands can be matched with a binary search
+	//Equal strings stay in list order so the first entry in the list still wins, the same as a linear scan
+	for(int n = 0; n < commandListEntries; n++){
+		uint8_t idx = n;
+		int pos = n;
+		while(pos > 0 && compareCommands(commandOrder[pos-1], idx) > 0){
+			commandOrder[pos] = commandOrder[pos-1];
+			pos--;
+		}
+		commandOrder[pos] = idx;
+	}
+}
+//==============================================================================================================
+int CommandTable::compareCommands(uint8_t a, uint8_t b) const{
+	//order two commands by string, then by length (a prefix comes first), then by index
+	uint8_t len = commandLengths[a] < commandLengths[b] ? commandLengths[a] : commandLengths[b];
+	int res = memcmp(commandList[a].commandString, commandList[b].commandString, len);
+	if(res != 0) return res;
+	if(commandLengths[a] != commandLengths[b]) return (int)commandLengths[a] - (int)commandLengths[b];
+	return (int)a - (int)b;
+}
+//==============================================================================================================
+int CommandTable::find(const char* cmd, uint8_t length) const{
+	//binary search the sorted index for a command that exactly matches the first length chars of cmd
+	//returns the lowest list index of a matching command, or -1 if there is no match
+	int lo = 0, hi = commandListEntries;
+	while(lo < hi){
+		int mid = (lo + hi) / 2;
+		uint8_t idx = commandOrder[mid];
+		uint8_t len = commandLengths[idx] < length ? commandLengths[idx] : length;
+		int res = memcmp(commandList[idx].commandString, cmd, len);
+		if(res == 0) res = (int)commandLengths[idx] - (int)length;
+		if(res < 0) lo = mid + 1;
+		else 				hi = mid;
+	}
+	if(lo < commandListEntries){
+		uint8_t idx = commandOrder[lo];
+		if(commandLengths[idx] == length && memcmp(commandList[idx].commandString, cmd, length) == 0) return idx;
+	}
+	return -1;
+}
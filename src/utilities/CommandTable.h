@@ -0,0 +1,55 @@
+//Precomputed command table for Commander
+/*
+Holds a command list together with the data Commander derives from it: the length of each command, the longest
+command and an index of the list sorted by command string that is used to match commands with a binary search.
+The data is computed once when a list is attached, and the arrays are reused when another list of the same size
+or smaller is attached, so switching lists does not allocate. Any number of Commander objects can share one table with
+attachCommands(CommandTable&) so each session only needs its own buffer, state and ports.
+Commander objects that attach a plain command list use a table of their own, so existing sketches are unchanged.
+*/
+#ifndef CommandTable_h
+#define CommandTable_h
+
+#include <Arduino.h>
+#include <string.h>
+
+class Commander;
+
+typedef bool (*cmdHandler)(Commander& Cmdr); //command handler function pointer type
+//Command handler array type - contains command string and function pointer
+
+typedef struct commandList_t{
+	const char* commandString;
+  cmdHandler handler;
+	const char* manualString;
+} commandList_t;
+
+class CommandTable {
+public:
+	CommandTable() {}
+	CommandTable(const commandList_t *commands, uint32_t size) 	{attach(commands, size);}
+	~CommandTable();
+	CommandTable& attach(const commandList_t *commands, uint32_t size); //size is the size of the whole array in bytes
+	CommandTable& attachArray(const commandList_t *commands, uint32_t length); //length is the number of commands
+	CommandTable& compute(); //recompute the table after the command list has been changed
+	const commandList_t* list() const 									{return commandList;}
+	uint8_t 	entries() const 														{return commandListEntries;}
+	uint8_t 	commandLength(uint8_t index) const 					{return commandLengths[index];}
+	uint8_t 	longest() const 														{return longestCommand;}
+	int 			find(const char* cmd, uint8_t length) const; //index of the command that exactly matches the first length chars of cmd, or -1
+private:
+	friend class Commander;
+	CommandTable(const CommandTable&);
+	CommandTable& operator=(const CommandTable&);
+	uint8_t getLength(uint8_t index) const;
+	void sortCommands();
+	int compareCommands(uint8_t a, uint8_t b) const;
+	const commandList_t* commandList = NULL;
+	uint8_t commandListEntries = 0;
+	uint8_t* commandLengths = NULL;
+	uint8_t* commandOrder = NULL; //index of the command list sorted by command string
+	uint8_t tableCapacity = 0; //number of commands the arrays have room for
+	uint8_t longestCommand = 0;
+};
+
+#endif //CommandTable_h
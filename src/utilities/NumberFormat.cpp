@@ -0,0 +1,243 @@
+#include "NumberFormat.h"
+#include "BigNum.h"
+#include <float.h>
+
+//two digit lookup table - "00", "01" ... "99"
+#if defined(__AVR__)
+	#define PAIR_STORAGE PROGMEM //keep the table out of RAM
+	#define copyPair(dest, n) memcpy_P((dest), &digitPairs[(n) * 2], 2)
+#else
+	#define PAIR_STORAGE
+	#define copyPair(dest, n) memcpy((dest), &digitPairs[(n) * 2], 2)
+#endif
+static const char digitPairs[201] PAIR_STORAGE =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+//shortest numbers are written without an exponent if the first digit is between 10^-5 and 10^9
+#define SHORTEST_MIN_EXPONENT -5
+#define SHORTEST_MAX_EXPONENT 9
+
+//==============================================================================================================
+static uint64_t powerOfTen(uint8_t exponent){
+	uint64_t value = 1;
+	while(exponent--) value *= 10;
+	return value;
+}
+//==============================================================================================================
+static uint8_t formatSpecial(char* buf, double value){
+	//write nan or inf and return the length, or return 0 if the value is a normal number
+	const char* text = NULL;
+	if(value != value) text = "nan";
+	else if(value - value != 0) text = value < 0 ? "-inf" : "inf";
+	if(text == NULL) return 0;
+	strcpy(buf, text);
+	return strlen(text);
+}
+//==============================================================================================================
+static double scaleByTen(double value, int16_t exponent){
+	//multiply by 10^exponent. Powers of 10 up to 1e22 are exact so each step only rounds once
+	while(exponent != 0){
+		int16_t step = exponent > 22 ? 22 : (exponent < -22 ? -22 : exponent);
+		double scale = 1;
+		for(int16_t n = step < 0 ? -step : step; n > 0; n--) scale *= 10;
+		if(step > 0) value *= scale;
+		else 				 value /= scale;
+		exponent -= step;
+	}
+	return value;
+}
+//==============================================================================================================
+uint8_t formatUnsigned(char* buf, uint64_t value){
+	//fill a temporary buffer from the end, two digits at a time
+	char digits[20];
+	uint8_t pos = sizeof(digits);
+	//64 bit division is slow on small processors so only use it for the top digits of big numbers
+	while(value > 0xFFFFFFFFULL){
+		uint64_t quotient = value / 100;
+		pos -= 2;
+		copyPair(&digits[pos], (uint8_t)(value - quotient * 100));
+		value = quotient;
+	}
+	uint32_t small = (uint32_t)value;
+	while(small >= 100){
+		uint32_t quotient = small / 100;
+		pos -= 2;
+		copyPair(&digits[pos], (uint8_t)(small - quotient * 100));
+		small = quotient;
+	}
+	if(small >= 10){
+		pos -= 2;
+		copyPair(&digits[pos], (uint8_t)small);
+	}else digits[--pos] = '0' + small;
+	uint8_t length = sizeof(digits) - pos;
+	memcpy(buf, &digits[pos], length);
+	buf[length] = '\0';
+	return length;
+}
+//==============================================================================================================
+uint8_t formatInteger(char* buf, int64_t value){
+	if(value >= 0) return formatUnsigned(buf, (uint64_t)value);
+	buf[0] = '-';
+	return formatUnsigned(buf + 1, 0 - (uint64_t)value) + 1;
+}
+//==============================================================================================================
+uint8_t formatFixed(char* buf, double value, uint8_t decimals){
+	uint8_t length = formatSpecial(buf, value);
+	if(length) return length;
+	if(decimals > NUMBER_MAX_DECIMALS) decimals = NUMBER_MAX_DECIMALS;
+	bool negative = value < 0;
+	if(negative) value = -value;
+	double scaled = scaleByTen(value, decimals) + 0.5;
+	if(scaled >= 18446744073709551615.0) return formatShortest(buf, negative ? -value : value); //too big to print as a whole number
+	uint64_t whole = (uint64_t)scaled;
+	if(negative && whole > 0) buf[length++] = '-';
+	if(decimals == 0) return length + formatUnsigned(&buf[length], whole);
+	uint64_t divisor = powerOfTen(decimals);
+	length += formatUnsigned(&buf[length], whole / divisor);
+	buf[length++] = '.';
+	//pad the fraction with leading zeros
+	char fraction[21];
+	uint8_t fractionLength = formatUnsigned(fraction, whole % divisor);
+	for(uint8_t n = fractionLength; n < decimals; n++) buf[length++] = '0';
+	memcpy(&buf[length], fraction, fractionLength + 1);
+	return length + fractionLength;
+}
+//==============================================================================================================
+template <uint8_t WORDS>
+static uint8_t shortestDigits(char* digits, uint64_t mantissa, int16_t exponent, uint8_t mantissaBits, int16_t minExponent, int16_t &decimalExponent){
+	//Write the fewest digits that identify mantissa * 2^exponent, and the decimal exponent so the value is 0.digits * 10^decimalExponent
+	//This is the free format algorithm from Burger and Dybvig, "Printing Floating-Point Numbers Quickly and Accurately".
+	//r / s is the value and mPlus / s and mMinus / s are half the gaps to the next larger and smaller numbers.
+	bigNum_t<WORDS> r, s, mPlus, mMinus, high;
+	bool even = (mantissa & 1) == 0; //round half to even means the ends of the range read back as this value
+	bool unequalGaps = mantissa == (1ULL << (mantissaBits - 1)) && exponent > minExponent; //the gap below a power of 2 is half the gap above
+	r.set(mantissa);
+	s.set(1);
+	mMinus.set(1);
+	if(exponent >= 0){
+		r.shiftLeft(exponent + (unequalGaps ? 2 : 1));
+		s.shiftLeft(unequalGaps ? 2 : 1);
+		mMinus.shiftLeft(exponent);
+	}else{
+		r.shiftLeft(unequalGaps ? 2 : 1);
+		s.shiftLeft(-exponent + (unequalGaps ? 2 : 1));
+	}
+	mPlus = mMinus;
+	if(unequalGaps) mPlus.shiftLeft(1);
+	//estimate the decimal exponent - it can only be one too small, which is fixed below
+	double value = ldexp((double)mantissa, exponent);
+	int16_t k = (int16_t)ceil(log10(value) - 1e-10);
+	if(k >= 0) s.multiplyPow10(k);
+	else{
+		r.multiplyPow10(-k);
+		mPlus.multiplyPow10(-k);
+		mMinus.multiplyPow10(-k);
+	}
+	high.add(r, mPlus);
+	while(high.compare(s) >= (even ? 0 : 1)){
+		s.multiply(10);
+		k++;
+	}
+	decimalExponent = k;
+	uint8_t count = 0;
+	while(true){
+		r.multiply(10);
+		mPlus.multiply(10);
+		mMinus.multiply(10);
+		uint8_t digit = 0;
+		while(r.compare(s) >= 0){
+			r.subtract(s);
+			digit++;
+		}
+		high.add(r, mPlus);
+		bool low = r.compare(mMinus) < (even ? 1 : 0);
+		bool up = high.compare(s) >= (even ? 0 : 1);
+		if(!low && !up){
+			digits[count++] = '0' + digit;
+			continue;
+		}
+		if(low && up){
+			//both are in range, use whichever is closer
+			high.add(r, r);
+			up = high.compare(s) >= 0;
+		}
+		digits[count++] = '0' + digit + (up ? 1 : 0);
+		return count;
+	}
+}
+//==============================================================================================================
+static uint8_t layoutDigits(char* buf, const char* digits, uint8_t count, int16_t exponent){
+	//write d.ddd x 10^exponent, as a plain decimal if the exponent is in range
+	uint8_t length = 0;
+	if(exponent < SHORTEST_MIN_EXPONENT || exponent > SHORTEST_MAX_EXPONENT){
+		buf[length++] = digits[0];
+		if(count > 1){
+			buf[length++] = '.';
+			memcpy(&buf[length], &digits[1], count - 1);
+			length += count - 1;
+		}
+		buf[length++] = 'e';
+		return length + formatInteger(&buf[length], exponent);
+	}
+	if(exponent < 0){
+		buf[length++] = '0';
+		buf[length++] = '.';
+		for(int16_t n = exponent + 1; n < 0; n++) buf[length++] = '0';
+		memcpy(&buf[length], digits, count);
+		length += count;
+	}else if(count <= exponent + 1){
+		memcpy(&buf[length], digits, count);
+		length += count;
+		for(int16_t n = count; n <= exponent; n++) buf[length++] = '0';
+	}else{
+		memcpy(&buf[length], digits, exponent + 1);
+		length += exponent + 1;
+		buf[length++] = '.';
+		memcpy(&buf[length], &digits[exponent + 1], count - exponent - 1);
+		length += count - exponent - 1;
+	}
+	buf[length] = '\0';
+	return length;
+}
+//==============================================================================================================
+template <uint8_t WORDS>
+static uint8_t formatShortestBits(char* buf, double value, uint8_t mantissaBits, int16_t minExponent){
+	//split a float or double into a whole number mantissa and a power of 2, and write its shortest digits
+	uint8_t length = formatSpecial(buf, value);
+	if(length) return length;
+	if(value < 0){
+		buf[length++] = '-';
+		value = -value;
+	}
+	if(value == 0){
+		strcpy(&buf[length], "0");
+		return length + 1;
+	}
+	int binaryExponent = 0;
+	uint64_t mantissa = (uint64_t)ldexp(frexp(value, &binaryExponent), mantissaBits);
+	int16_t exponent = binaryExponent - mantissaBits;
+	if(exponent < minExponent){
+		//subnormal numbers have fewer mantissa bits
+		mantissa >>= (minExponent - exponent);
+		exponent = minExponent;
+	}
+	char digits[20];
+	int16_t decimalExponent = 0;
+	uint8_t count = shortestDigits<WORDS>(digits, mantissa, exponent, mantissaBits, minExponent, decimalExponent);
+	return length + layoutDigits(&buf[length], digits, count, decimalExponent - 1);
+}
+//==============================================================================================================
+uint8_t formatShortest(char* buf, double value){
+	//the digit generator needs about 1100 bits for the smallest and largest doubles, and about 160 bits for floats
+#if DBL_MANT_DIG > FLT_MANT_DIG
+	return formatShortestBits<36>(buf, value, DBL_MANT_DIG, DBL_MIN_EXP - DBL_MANT_DIG);
+#else
+	return formatShortestBits<6>(buf, value, DBL_MANT_DIG, DBL_MIN_EXP - DBL_MANT_DIG);
+#endif
+}
+//==============================================================================================================
+uint8_t formatShortest(char* buf, float value){
+	return formatShortestBits<6>(buf, value, FLT_MANT_DIG, FLT_MIN_EXP - FLT_MANT_DIG);
+}
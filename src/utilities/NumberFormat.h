@@ -0,0 +1,30 @@
+//Number formatting for Commander
+/*
+Formats numbers into a char buffer so a reply can be written in one block instead of a char at a time.
+Each function writes a null terminated string and returns its length.
+
+Integers are converted two digits at a time from a lookup table, and only use 64 bit division for values that need it.
+Floats and doubles can be printed with a fixed number of decimal places, like Print::print(float, decimals),
+or with NUMBER_SHORTEST, which prints the fewest significant digits that read back as exactly the same value,
+whether they are read by getFloat(), getDouble() and the set command, or by strtod().
+Floats are printed with the digits needed for a float, so 0.1f prints as 0.1 rather than 0.100000001
+Shortest numbers use an exponent if they are very large or very small, EG 1.5e-7
+*/
+#ifndef NumberFormat_h
+#define NumberFormat_h
+
+#include <Arduino.h>
+
+#define NUMBER_BUFFER_SIZE 	32 //big enough for any number these functions write
+#define NUMBER_SHORTEST 		-1 //pass as decimals to print the shortest string that round trips
+#define NUMBER_MAX_DECIMALS 15
+
+uint8_t formatUnsigned(char* buf, uint64_t value);
+uint8_t formatInteger(char* buf, int64_t value);
+//fixed number of decimal places (up to NUMBER_MAX_DECIMALS), rounded half away from zero
+uint8_t formatFixed(char* buf, double value, uint8_t decimals);
+//fewest significant digits that read back as exactly the same value
+uint8_t formatShortest(char* buf, double value);
+uint8_t formatShortest(char* buf, float value);
+
+#endif //NumberFormat_h
@@ -0,0 +1,347 @@
+#include "NumberParser.h"
+#include "BigNum.h"
+#include <float.h>
+
+//Limits for reading decimals into a double. Decimals with more significant digits than PARSE_MAX_DIGITS can't round
+//differently from the first PARSE_MAX_DIGITS digits followed by a 1, and anything below 10^PARSE_ZERO_POWER rounds to 0
+#if DBL_MANT_DIG > FLT_MANT_DIG
+	#define PARSE_EXACT_POW10 	22 		//largest power of 10 a double holds exactly
+	#define PARSE_MAX_DIGITS 		769
+	#define PARSE_ZERO_POWER 		-324
+	#define PARSE_BIG_WORDS 		88 		//enough for the digits and the power of 5 of the smallest double
+#else
+	#define PARSE_EXACT_POW10 	10
+	#define PARSE_MAX_DIGITS 		114
+	#define PARSE_ZERO_POWER 		-46
+	#define PARSE_BIG_WORDS 		16
+#endif
+
+//The parts of a number found by scanNumber()
+typedef struct numScan_t{
+	uint64_t mantissa = 0; 	//significant digits
+	int16_t exponent = 0; 	//power of 10 to multiply the mantissa by
+	int16_t power = 0; 			//the exponent or suffix written after the digits
+	const char* digits = NULL; //the first digit of a decimal number
+	bool negative = false;
+	bool overflow = false; 	//a hex or binary number had too many digits
+	bool truncated = false; //a decimal had more digits than the mantissa holds and some of them were not zero
+} numScan_t;
+
+static bool isDecimalDigit(char ch) 	{return ch >= '0' && ch <= '9';}
+static bool isAlphaNum(char ch) 	{return isDecimalDigit(ch) || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');}
+
+static int8_t hexValue(char ch){
+	if(ch >= '0' && ch <= '9') return ch - '0';
+	if(ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+	if(ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+	return -1;
+}
+
+static int8_t suffixExponent(char ch){
+	switch(ch){
+		case 'p': return -12;
+		case 'n': return -9;
+		case 'u': return -6;
+		case 'm': return -3;
+		case 'k': return 3;
+		case 'K': return 3;
+		case 'M': return 6;
+		case 'G': return 9;
+		case 'T': return 12;
+	}
+	return 0;
+}
+//==============================================================================================================
+static const char* scanNumber(const char* str, numScan_t &num, uint8_t options, bool integer){
+	//split a number into sign, mantissa and exponent. Returns str if there is no number
+	//if integer is true it stops at a decimal point or exponent, and only takes suffixes that make the number bigger
+	const char* p = str;
+	if(*p == '-' || *p == '+'){
+		num.negative = (*p == '-');
+		p++;
+	}
+	if(p[0] == '0' && (p[1] == 'x' || p[1] == 'X') && hexValue(p[2]) >= 0){
+		p += 2;
+		for(int8_t digit = hexValue(*p); digit >= 0; digit = hexValue(*++p)){
+			if(num.mantissa >> 60) num.overflow = true;
+			num.mantissa = (num.mantissa << 4) | digit;
+		}
+		return p;
+	}
+	if(p[0] == '0' && (p[1] == 'b' || p[1] == 'B') && (p[2] == '0' || p[2] == '1')){
+		p += 2;
+		for(; *p == '0' || *p == '1'; p++){
+			if(num.mantissa >> 63) num.overflow = true;
+			num.mantissa = (num.mantissa << 1) | (*p - '0');
+		}
+		return p;
+	}
+	//decimal - keep as many digits as fit in the mantissa, digits after that only change the exponent
+	const uint64_t mantissaLimit = (0xFFFFFFFFFFFFFFFFULL - 9) / 10;
+	bool digits = false;
+	num.digits = p;
+	for(; isDecimalDigit(*p); p++){
+		digits = true;
+		if(num.mantissa <= mantissaLimit) num.mantissa = num.mantissa * 10 + (*p - '0');
+		else{
+			num.exponent++;
+			if(*p != '0') num.truncated = true;
+		}
+	}
+	if(*p == '.' && !integer){
+		for(p++; isDecimalDigit(*p); p++){
+			digits = true;
+			if(num.mantissa <= mantissaLimit){
+				num.mantissa = num.mantissa * 10 + (*p - '0');
+				num.exponent--;
+			}else if(*p != '0') num.truncated = true;
+		}
+	}
+	if(!digits) return str;
+	if(!integer && (*p == 'e' || *p == 'E') && (isDecimalDigit(p[1]) || ((p[1] == '-' || p[1] == '+') && isDecimalDigit(p[2])))){
+		p++;
+		bool negativeExponent = (*p == '-');
+		if(*p == '-' || *p == '+') p++;
+		int16_t exp = 0;
+		for(; isDecimalDigit(*p); p++) if(exp < 1000) exp = exp * 10 + (*p - '0');
+		num.power = negativeExponent ? -exp : exp;
+	}else if((options & PARSE_SUFFIXES) && suffixExponent(*p) != 0 && !isAlphaNum(p[1]) && (!integer || suffixExponent(*p) > 0)){
+		num.power = suffixExponent(*p);
+		p++;
+	}
+	num.exponent += num.power;
+	return p;
+}
+//==============================================================================================================
+static bool scaleUp(uint64_t &value, int16_t exponent){
+	//multiply by 10^exponent, returns false on overflow
+	if(value == 0) return true;
+	for(; exponent > 0; exponent--){
+		if(value > 0xFFFFFFFFFFFFFFFFULL / 10) return false;
+		value *= 10;
+	}
+	return true;
+}
+//==============================================================================================================
+const char* parseInteger(const char* str, int64_t &value, uint8_t &status, uint8_t options){
+	//parse an integer - it stops at a decimal point, the same as atol()
+	numScan_t num;
+	const char* end = scanNumber(str, num, options, true);
+	value = 0;
+	if(end == str){
+		status = PARSE_NO_NUMBER;
+		return str;
+	}
+	uint64_t magnitude = num.mantissa;
+	bool overflow = num.overflow || !scaleUp(magnitude, num.exponent);
+	for(int16_t n = num.exponent; n < 0 && magnitude > 0; n++) magnitude /= 10;
+	const uint64_t limit = num.negative ? 0x8000000000000000ULL : 0x7FFFFFFFFFFFFFFFULL;
+	if(overflow || magnitude > limit){
+		magnitude = limit;
+		overflow = true;
+	}
+	value = num.negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+	status = overflow ? PARSE_OVERFLOW : PARSE_OK;
+	return end;
+}
+//==============================================================================================================
+template <uint8_t WORDS>
+static int16_t decimalDigits(const numScan_t &num, bigNum_t<WORDS>* digits, uint16_t &count){
+	//Read the significant digits of a decimal again, without the mantissa's limit, into digits (if it isn't NULL).
+	//Returns the power of 10 of the last digit and sets count to the number of significant digits.
+	//Digits past PARSE_MAX_DIGITS are replaced by a single 1 if any of them are not zero.
+	int16_t exponent = num.power;
+	bool fraction = false;
+	bool sticky = false;
+	uint32_t chunk = 0; //digits are added to the big number nine at a time
+	uint8_t chunkDigits = 0;
+	count = 0;
+	if(digits) digits->set(0);
+	for(const char* p = num.digits; ; p++){
+		if(*p == '.' && !fraction){
+			fraction = true;
+			continue;
+		}
+		if(!isDecimalDigit(*p)) break;
+		uint8_t digit = *p - '0';
+		if(count == 0 && digit == 0){
+			//leading zeros
+			if(fraction) exponent--;
+			continue;
+		}
+		if(count == PARSE_MAX_DIGITS){
+			if(digit) sticky = true;
+			if(!fraction) exponent++;
+			continue;
+		}
+		count++;
+		if(fraction) exponent--;
+		chunk = chunk * 10 + digit;
+		if(++chunkDigits == 9){
+			if(digits) digits->multiply(1000000000UL, chunk);
+			chunk = 0;
+			chunkDigits = 0;
+		}
+	}
+	if(sticky){
+		count++;
+		exponent--;
+		chunk = chunk * 10 + 1;
+		chunkDigits++;
+	}
+	if(chunkDigits && digits){
+		uint32_t factor = 1;
+		while(chunkDigits--) factor *= 10;
+		digits->multiply(factor, chunk);
+	}
+	return exponent;
+}
+//==============================================================================================================
+static int8_t compareHalfway(const numScan_t &num, uint64_t mantissa, int16_t exponent){
+	//Compare the decimal with the point halfway between mantissa * 2^exponent and the next double up, (2 * mantissa + 1) * 2^(exponent-1)
+	//Returns -1 if the decimal is below it, 0 if it is exactly halfway and 1 if it is above
+	bigNum_t<PARSE_BIG_WORDS> decimal, halfway;
+	uint16_t count;
+	int16_t decimalExponent = decimalDigits<PARSE_BIG_WORDS>(num, &decimal, count);
+	halfway.set(2 * mantissa + 1);
+	//10^n is 5^n * 2^n, so the powers of 5 are multiplied in and the powers of 2 are shifted in after they cancel out
+	int16_t decimalTwos = 0, halfwayTwos = 0;
+	if(decimalExponent >= 0){
+		decimal.multiplyPow5(decimalExponent);
+		decimalTwos = decimalExponent;
+	}else{
+		halfway.multiplyPow5(-decimalExponent);
+		halfwayTwos = -decimalExponent;
+	}
+	if(exponent - 1 >= 0) halfwayTwos += exponent - 1;
+	else 									decimalTwos -= exponent - 1;
+	if(decimalTwos > halfwayTwos) decimal.shiftLeft(decimalTwos - halfwayTwos);
+	else 													halfway.shiftLeft(halfwayTwos - decimalTwos);
+	return decimal.compare(halfway);
+}
+//==============================================================================================================
+static double scaleDecimal(double value, int16_t exponent){
+	//multiply by 10^exponent. Powers of 10 up to PARSE_EXACT_POW10 are exact, so each step rounds once
+	while(exponent != 0){
+		int16_t step = exponent > PARSE_EXACT_POW10 ? PARSE_EXACT_POW10 : (exponent < -PARSE_EXACT_POW10 ? -PARSE_EXACT_POW10 : exponent);
+		double scale = 1;
+		for(int16_t n = step < 0 ? -step : step; n > 0; n--) scale *= 10;
+		if(step > 0) value *= scale;
+		else 				 value /= scale;
+		exponent -= step;
+		if(value == 0 || value - value != 0) break; //underflow or infinity
+	}
+	return value;
+}
+//==============================================================================================================
+static double roundDecimal(const numScan_t &num, uint8_t &status){
+	//Correctly rounded conversion of a decimal that the quick path can't do exactly.
+	//The quick conversion is within a few steps of the right double, so starting from there the decimal is compared
+	//exactly with the halfway points either side, and the double moves one step at a time until the decimal lies between them.
+	const uint64_t hidden = 1ULL << (DBL_MANT_DIG - 1);
+	const int16_t minExponent = DBL_MIN_EXP - DBL_MANT_DIG; 	//exponent of the subnormal numbers
+	const int16_t maxExponent = DBL_MAX_EXP - DBL_MANT_DIG; 	//exponent of the largest numbers
+	uint16_t count;
+	int16_t decimalExponent = decimalDigits<PARSE_BIG_WORDS>(num, NULL, count);
+	if(count + decimalExponent <= PARSE_ZERO_POWER) return 0;
+	if(count - 1 + decimalExponent > DBL_MAX_10_EXP){
+		status = PARSE_OVERFLOW;
+		return scaleDecimal(DBL_MAX, 1); //infinity
+	}
+	double estimate = scaleDecimal((double)num.mantissa, num.exponent);
+	//split the estimate into a whole number mantissa and a power of 2
+	uint64_t mantissa = 0;
+	int16_t exponent = minExponent;
+	if(estimate - estimate != 0){
+		mantissa = (hidden << 1) - 1; //start from the largest double
+		exponent = maxExponent;
+	}else if(estimate != 0){
+		int binaryExponent = 0;
+		mantissa = (uint64_t)ldexp(frexp(estimate, &binaryExponent), DBL_MANT_DIG);
+		exponent = binaryExponent - DBL_MANT_DIG;
+		if(exponent < minExponent){
+			mantissa >>= (minExponent - exponent);
+			exponent = minExponent;
+		}
+	}
+	while(exponent <= maxExponent){
+		//halfway cases go to the double with an even mantissa
+		int8_t above = compareHalfway(num, mantissa, exponent);
+		if(above > 0 || (above == 0 && (mantissa & 1))){
+			if(++mantissa == (hidden << 1)){
+				mantissa = hidden;
+				exponent++;
+			}
+			continue;
+		}
+		if(mantissa == 0) break;
+		uint64_t lowerMantissa = mantissa - 1;
+		int16_t lowerExponent = exponent;
+		if(mantissa == hidden && exponent > minExponent){
+			lowerMantissa = (hidden << 1) - 1;
+			lowerExponent--;
+		}
+		int8_t below = compareHalfway(num, lowerMantissa, lowerExponent);
+		if(below < 0 || (below == 0 && (mantissa & 1))){
+			mantissa = lowerMantissa;
+			exponent = lowerExponent;
+			continue;
+		}
+		break;
+	}
+	if(exponent > maxExponent){
+		status = PARSE_OVERFLOW;
+		return scaleDecimal(DBL_MAX, 1); //infinity
+	}
+	return ldexp((double)mantissa, exponent);
+}
+//==============================================================================================================
+const char* parseDouble(const char* str, double &value, uint8_t &status, uint8_t options){
+	numScan_t num;
+	const char* end = scanNumber(str, num, options, false);
+	value = 0;
+	if(end == str){
+		status = PARSE_NO_NUMBER;
+		return str;
+	}
+	status = PARSE_OK;
+	if(num.digits == NULL || num.mantissa == 0){
+		//hex and binary numbers are whole numbers with no exponent, so the conversion rounds once
+		value = (double)num.mantissa;
+	}else if(!num.truncated && num.mantissa <= (1ULL << DBL_MANT_DIG) && num.exponent >= -PARSE_EXACT_POW10 && num.exponent <= PARSE_EXACT_POW10){
+		//the mantissa and the power of 10 are both exact, so one multiply or divide is correctly rounded
+		value = scaleDecimal((double)num.mantissa, num.exponent);
+	}else value = roundDecimal(num, status);
+	if(num.negative) value = -value;
+	return end;
+}
+//==============================================================================================================
+const char* parseFixed(const char* str, int32_t &value, uint8_t decimals, uint8_t &status, uint8_t options){
+	numScan_t num;
+	const char* end = scanNumber(str, num, options, false);
+	value = 0;
+	if(end == str){
+		status = PARSE_NO_NUMBER;
+		return str;
+	}
+	uint64_t magnitude = num.mantissa;
+	int16_t exponent = num.exponent + decimals;
+	bool overflow = num.overflow || !scaleUp(magnitude, exponent);
+	if(exponent < 0){
+		//divide, rounding half away from zero
+		uint64_t remainder = 0;
+		for(; exponent < 0 && magnitude > 0; exponent++){
+			remainder = magnitude % 10;
+			magnitude /= 10;
+		}
+		if(remainder >= 5 && exponent == 0) magnitude++;
+	}
+	const uint64_t limit = num.negative ? 0x80000000ULL : 0x7FFFFFFFULL;
+	if(overflow || magnitude > limit){
+		magnitude = limit;
+		overflow = true;
+	}
+	value = num.negative ? (int32_t)(0 - (uint32_t)magnitude) : (int32_t)magnitude;
+	status = overflow ? PARSE_OVERFLOW : PARSE_OK;
+	return end;
+}
@@ -0,0 +1,38 @@
+//Number parsing for Commander
+/*
+Parses numbers straight from a null terminated char buffer without making a copy, in the style of std::from_chars.
+Each function returns a pointer to the first char after the number (or to the start if there was no number) and
+sets a status code, so the caller knows where parsing stopped and whether the value was valid.
+Parsing does not depend on the C locale - the decimal point is always '.'
+
+Accepted formats:
+	Decimal integers and decimals with an optional sign: 42, -7, 3.14159, +0.5
+	Exponents: 1.5e3, 2E-6
+	Hexadecimal and binary integers: 0x1F, 0b1010
+	Engineering suffixes directly after a decimal number, if PARSE_SUFFIXES is passed: p n u m k K M G T (1.5k = 1500, 10m = 0.01)
+	A suffix is only used if it is not followed by another letter or digit, so 10kg is read as 10
+
+parseInteger() only reads whole numbers, so it stops at a decimal point or exponent (2.7 and 1e3 are read as 2 and 1,
+and the caller can see from the end pointer that the number carried on). It only accepts the k K M G T suffixes.
+*/
+#ifndef NumberParser_h
+#define NumberParser_h
+
+#include <Arduino.h>
+
+//status codes for the parse functions
+#define PARSE_OK 					0 //a number was parsed
+#define PARSE_NO_NUMBER 	1 //there was no number at the start of the string
+#define PARSE_OVERFLOW 		2 //the number was too big for the type - the value is clamped to the largest value of the right sign
+#define PARSE_TRAILING 		3 //a number was parsed but it was followed by other characters (set by Commander, not the parser)
+
+//options for the parse functions
+#define PARSE_DEFAULT 		0x00
+#define PARSE_SUFFIXES 		0x01 //accept engineering suffixes
+
+const char* parseInteger(const char* str, int64_t &value, uint8_t &status, uint8_t options = PARSE_DEFAULT);
+const char* parseDouble(const char* str, double &value, uint8_t &status, uint8_t options = PARSE_DEFAULT);
+//parse a decimal number into an integer scaled by 10^decimals, EG 3.14159 with 3 decimals is 3142. Does not use floating point
+const char* parseFixed(const char* str, int32_t &value, uint8_t decimals, uint8_t &status, uint8_t options = PARSE_DEFAULT);
+
+#endif //NumberParser_h
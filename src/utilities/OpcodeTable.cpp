@@ -0,0 +1,73 @@
+#include "OpcodeTable.h"
+
+//a direct table is used if it would have no more than this many slots per opcode
+#define OPCODE_DIRECT_SPREAD 4
+
+//==============================================================================================================
+OpcodeTable& OpcodeTable::attach(const opcodeList_t *opcodes, uint32_t size){
+	return attachArray(opcodes, size / sizeof(opcodeList_t));
+}
+//==============================================================================================================
+OpcodeTable& OpcodeTable::attachArray(const opcodeList_t *opcodes, uint32_t length){
+	opcodeList = opcodes;
+	opcodeEntries = length > 254 ? 254 : length;
+	return compute();
+}
+//==============================================================================================================
+OpcodeTable& OpcodeTable::compute(){
+	slotCount = 0;
+	if(opcodeEntries == 0) return *this;
+	int32_t highest = opcodeList[0].opcode;
+	lowest = highest;
+	for(uint8_t n = 1; n < opcodeEntries; n++){
+		if(opcodeList[n].opcode < lowest) lowest = opcodeList[n].opcode;
+		if(opcodeList[n].opcode > highest) highest = opcodeList[n].opcode;
+	}
+	//use a direct table if the opcodes are close together, otherwise a hash table that is at most half full
+	uint32_t span = (uint32_t)highest - (uint32_t)lowest + 1; //unsigned so a huge span can't overflow
+	direct = span != 0 && span <= (uint32_t)opcodeEntries * OPCODE_DIRECT_SPREAD;
+	uint16_t needed = opcodeEntries * 2;
+	if(direct) needed = span;
+	else{
+		uint16_t size = 4;
+		while(size < needed) size <<= 1; //power of two so the hash is a mask
+		needed = size;
+	}
+	//the slots are only reallocated if the new table is bigger
+	if(needed > slotCapacity){
+		if(slots) delete [] slots;
+		slots = new uint8_t[needed];
+		slotCapacity = slots ? needed : 0;
+		if(!slots) return *this;
+	}
+	slotCount = needed;
+	memset(slots, 0, slotCount);
+	for(uint8_t n = 0; n < opcodeEntries; n++){
+		uint16_t slot = direct ? (uint16_t)((uint32_t)opcodeList[n].opcode - (uint32_t)lowest) : hashSlot(opcodeList[n].opcode);
+		if(!direct){
+			while(slots[slot] && opcodeList[slots[slot]-1].opcode != opcodeList[n].opcode) slot = (slot + 1) & (slotCount - 1);
+		}
+		if(slots[slot] == 0) slots[slot] = n + 1; //if an opcode is listed twice the first one wins
+	}
+	return *this;
+}
+//==============================================================================================================
+uint16_t OpcodeTable::hashSlot(int32_t opcode) const{
+	//Fibonacci hashing - spreads sequences like 100, 200, 300 over the table
+	return (uint16_t)(((uint32_t)opcode * 2654435769UL) >> 16) & (slotCount - 1);
+}
+//==============================================================================================================
+int OpcodeTable::find(int32_t opcode) const{
+	if(slotCount == 0) return -1;
+	if(direct){
+		uint32_t slot = (uint32_t)opcode - (uint32_t)lowest; //opcodes below the lowest wrap around to a big number
+		if(slot >= slotCount) return -1;
+		return (int)slots[slot] - 1;
+	}
+	uint16_t slot = hashSlot(opcode);
+	while(slots[slot]){
+		if(opcodeList[slots[slot]-1].opcode == opcode) return slots[slot] - 1;
+		slot = (slot + 1) & (slotCount - 1);
+	}
+	return -1;
+}
@@ -0,0 +1,49 @@
+//Numeric opcode table for Commander
+/*
+Maps integer opcodes to command handlers so machine clients can send short numeric commands like "12 3.5".
+When a line starts with a number and an opcode table is attached, the number is looked up in the table and the
+handler is called with the payload cursor on the first item after the opcode, just like a text command.
+Numbers that are not in the table still go to the special handler (attachSpecialHandler()).
+
+The lookup is computed once when a list is attached. If the opcodes are close together they index a direct table,
+otherwise they go in a small open addressed hash table. Either way finding a handler takes the same time however
+many opcodes there are. A table holds up to 254 opcodes.
+*/
+#ifndef OpcodeTable_h
+#define OpcodeTable_h
+
+#include <Arduino.h>
+#include "CommandTable.h"
+
+typedef struct opcodeList_t{
+	int32_t opcode;
+	cmdHandler handler;
+	const char* manualString;
+} opcodeList_t;
+
+class OpcodeTable {
+public:
+	OpcodeTable() {}
+	OpcodeTable(const opcodeList_t *opcodes, uint32_t size) 	{attach(opcodes, size);}
+	~OpcodeTable() 																						{if(slots) delete [] slots;}
+	OpcodeTable& attach(const opcodeList_t *opcodes, uint32_t size); //size is the size of the whole array in bytes
+	OpcodeTable& attachArray(const opcodeList_t *opcodes, uint32_t length); //length is the number of opcodes
+	OpcodeTable& compute(); //recompute the lookup after the opcode list has been changed
+	const opcodeList_t* list() const 												{return opcodeList;}
+	uint8_t 	entries() const 															{return opcodeEntries;}
+	bool 			isDirect() const 															{return direct;} //true if opcodes index a table directly rather than a hash table
+	int 			find(int32_t opcode) const; //index of the opcode in the list, or -1
+private:
+	OpcodeTable(const OpcodeTable&);
+	OpcodeTable& operator=(const OpcodeTable&);
+	uint16_t hashSlot(int32_t opcode) const;
+	const opcodeList_t* opcodeList = NULL;
+	uint8_t opcodeEntries = 0;
+	uint8_t* slots = NULL; //list index + 1 for each slot, 0 if the slot is empty
+	uint16_t slotCount = 0;
+	uint16_t slotCapacity = 0;
+	int32_t lowest = 0; //opcode in slot 0 of a direct table
+	bool direct = true;
+};
+
+#endif //OpcodeTable_h
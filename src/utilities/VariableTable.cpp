@@ -0,0 +1,81 @@
+#include "VariableTable.h"
+
+//==============================================================================================================
+VariableTable& VariableTable::attach(const variableList_t *vars, uint32_t size){
+	return attachArray(vars, size / sizeof(variableList_t));
+}
+//==============================================================================================================
+VariableTable& VariableTable::attachArray(const variableList_t *vars, uint32_t length){
+	varList = vars;
+	varEntries = length > 254 ? 254 : length;
+	return compute();
+}
+//==============================================================================================================
+VariableTable& VariableTable::compute(){
+	slotCount = 0;
+	if(varEntries == 0) return *this;
+	//a hash table that is at most half full
+	uint16_t needed = 4;
+	while(needed < varEntries * 2) needed <<= 1; //power of two so the hash is a mask
+	//the slots are only reallocated if the new table is bigger
+	if(needed > slotCapacity){
+		if(slots) delete [] slots;
+		slots = new uint8_t[needed];
+		slotCapacity = slots ? needed : 0;
+		if(!slots) return *this;
+	}
+	slotCount = needed;
+	memset(slots, 0, slotCount);
+	for(uint8_t n = 0; n < varEntries; n++){
+		uint16_t length = strlen(varList[n].name);
+		if(find(varList[n].name, length) > -1) continue; //if a name is listed twice the first one wins
+		uint16_t slot = hashSlot(varList[n].name, length);
+		while(slots[slot]) slot = (slot + 1) & (slotCount - 1);
+		slots[slot] = n + 1;
+	}
+	return *this;
+}
+//==============================================================================================================
+uint16_t VariableTable::hashSlot(const char* name, uint16_t length) const{
+	//FNV-1a, folded to 16 bits
+	uint32_t hash = 2166136261UL;
+	for(uint16_t n = 0; n < length; n++){
+		hash ^= (uint8_t)name[n];
+		hash *= 16777619UL;
+	}
+	return (uint16_t)(hash ^ (hash >> 16)) & (slotCount - 1);
+}
+//==============================================================================================================
+int VariableTable::find(const char* name, uint16_t length) const{
+	if(slotCount == 0) return -1;
+	uint16_t slot = hashSlot(name, length);
+	while(slots[slot]){
+		const char* entry = varList[slots[slot]-1].name;
+		if(strncmp(entry, name, length) == 0 && entry[length] == '\0') return slots[slot] - 1;
+		slot = (slot + 1) & (slotCount - 1);
+	}
+	return -1;
+}
+//==============================================================================================================
+uint32_t VariableTable::fingerprint(uint8_t idx) const{
+	//FNV-1a of the value
+	const variableList_t &var = varList[idx];
+	const uint8_t* data = (const uint8_t*)var.variable;
+	uint16_t length = 0;
+	switch(var.type){
+	case VAR_INT: 		length = sizeof(int); break;
+	case VAR_FLOAT: 	length = sizeof(float); break;
+	case VAR_DOUBLE: 	length = sizeof(double); break;
+	case VAR_BOOL: 		length = sizeof(bool); break;
+	case VAR_STRING:
+		data = (const uint8_t*)((String*)var.variable)->c_str();
+		length = ((String*)var.variable)->length();
+		break;
+	}
+	uint32_t hash = 2166136261UL;
+	for(uint16_t n = 0; n < length; n++){
+		hash ^= data[n];
+		hash *= 16777619UL;
+	}
+	return hash;
+}
@@ -0,0 +1,71 @@
+//Named variable table for Commander
+/*
+Lets a list of variables be read and written by name without writing a handler for each one.
+Each entry binds a name to an int, float, double, bool or String variable, with an optional range for numbers.
+When a table is attached with attachVariables() the internal commands get, set, dump, watch and unwatch are enabled:
+	get speed gain		prints speed=10 and gain=0.5
+	set speed 20 gain 1.5	sets both and prints the new values
+	dump			prints every variable
+	watch speed gain 20	prints 'speed=10 gain=0.5' from update() every 20ms
+	watch speed 100 change	only prints speed if it has changed since it was last printed
+	unwatch speed		stops watching speed, unwatch on its own stops watching everything
+User commands with the same name take priority over the internal commands.
+
+Names are looked up in a small open addressed hash table that is computed once when the list is attached,
+so finding a variable takes the same time however many there are. A table holds up to 254 variables.
+Names can't contain delimiters. Numbers outside the range are clamped to it. The range is ignored if min and max are equal.
+*/
+#ifndef VariableTable_h
+#define VariableTable_h
+
+#include <Arduino.h>
+#include "NumberFormat.h"
+
+typedef enum varType_t{
+	VAR_INT = 0,
+	VAR_FLOAT,
+	VAR_DOUBLE,
+	VAR_BOOL,
+	VAR_STRING
+} varType_t;
+
+typedef struct variableList_t{
+	const char* name;
+	varType_t type;
+	void* variable;
+	double min;
+	double max;
+} variableList_t;
+
+#define DEFAULT_VARIABLE_DIGITS NUMBER_SHORTEST //decimal places printed for float and double variables, NUMBER_SHORTEST prints the fewest digits that read back as the same value
+#define DEFAULT_WATCH_PERIOD 1000 //ms between samples if the watch command doesn't give a period
+#define MIN_WATCH_PERIOD 10 //shorter periods are raised to this so a watch can't flood the port
+
+class VariableTable {
+public:
+	VariableTable() {}
+	VariableTable(const variableList_t *vars, uint32_t size) 	{attach(vars, size);}
+	~VariableTable() 																					{if(slots) delete [] slots;}
+	VariableTable& attach(const variableList_t *vars, uint32_t size); //size is the size of the whole array in bytes
+	VariableTable& attachArray(const variableList_t *vars, uint32_t length); //length is the number of variables
+	VariableTable& compute(); //recompute the lookup after the variable list has been changed
+	const variableList_t* list() const 												{return varList;}
+	uint8_t 	entries() const 																{return varEntries;}
+	int 			find(const char* name) const 										{return find(name, strlen(name));}
+	int 			find(const char* name, uint16_t length) const; //index of the variable in the list, or -1
+	uint32_t 	fingerprint(uint8_t idx) const; //hash of the current value, used to see if it has changed
+	VariableTable& precision(int8_t digits) 									{floatDigits = digits; return *this;}
+	int8_t 		precision() const 															{return floatDigits;}
+private:
+	VariableTable(const VariableTable&);
+	VariableTable& operator=(const VariableTable&);
+	uint16_t hashSlot(const char* name, uint16_t length) const;
+	const variableList_t* varList = NULL;
+	uint8_t varEntries = 0;
+	uint8_t* slots = NULL; //list index + 1 for each slot, 0 if the slot is empty
+	uint16_t slotCount = 0;
+	uint16_t slotCapacity = 0;
+	int8_t floatDigits = DEFAULT_VARIABLE_DIGITS;
+};
+
+#endif //VariableTable_h
@@ -0,0 +1,72 @@
+//Checks for the host tests
+/*
+TEST(name) declares a test and registers it, CHECK(condition) records a failure without stopping the test
+and CHECK_EQUAL(expected, actual) prints both values when they differ.
+runTests() runs every registered test and returns the number of failures so main() can return it.
+*/
+#ifndef HostTest_h
+#define HostTest_h
+
+#include <stdio.h>
+#include <string>
+#include <sstream>
+
+typedef void (*hostTest_t)();
+
+struct hostTestEntry_t{
+	const char* name;
+	hostTest_t test;
+	hostTestEntry_t* next;
+};
+
+inline hostTestEntry_t*& hostTestList() 		{static hostTestEntry_t* list = NULL; return list;}
+inline int& hostTestFailures() 							{static int failures = 0; return failures;}
+
+struct hostTestRegister_t{
+	hostTestRegister_t(hostTestEntry_t* entry) 	{entry->next = hostTestList(); hostTestList() = entry;}
+};
+
+#define TEST(name) \
+	static void name(); \
+	static hostTestEntry_t name##Entry = {#name, name, NULL}; \
+	static hostTestRegister_t name##Register(&name##Entry); \
+	static void name()
+
+#define CHECK(condition) do{ \
+	if(!(condition)){ \
+		printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+		hostTestFailures()++; \
+	} \
+}while(0)
+
+#define CHECK_EQUAL(expected, actual) do{ \
+	std::ostringstream hostExpected, hostActual; \
+	hostExpected << (expected); \
+	hostActual << (actual); \
+	if(hostExpected.str() != hostActual.str()){ \
+		printf("%s:%d: expected '%s' but got '%s'\n", __FILE__, __LINE__, hostExpected.str().c_str(), hostActual.str().c_str()); \
+		hostTestFailures()++; \
+	} \
+}while(0)
+
+inline int runTests(){
+	//the list is built backwards so reverse it to run the tests in the order they are written
+	hostTestEntry_t* ordered = NULL;
+	while(hostTestList()){
+		hostTestEntry_t* entry = hostTestList();
+		hostTestList() = entry->next;
+		entry->next = ordered;
+		ordered = entry;
+	}
+	int count = 0;
+	for(hostTestEntry_t* entry = ordered; entry; entry = entry->next){
+		int before = hostTestFailures();
+		entry->test();
+		printf("%s %s\n", hostTestFailures() == before ? "pass" : "FAIL", entry->name);
+		count++;
+	}
+	printf("%d tests, %d failures\n", count, hostTestFailures());
+	return hostTestFailures();
+}
+
+#endif //HostTest_h
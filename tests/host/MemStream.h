@@ -0,0 +1,32 @@
+//A Stream in memory for the host tests
+/*
+feed() queues bytes for Commander to read, and take() returns everything Commander has written since the last take().
+writeRoom sets what availableForWrite() reports, -1 for a port that always has room.
+writes counts the calls to write() so tests can see how many blocks a reply was sent in.
+*/
+#ifndef MemStream_h
+#define MemStream_h
+
+#include <Arduino.h>
+#include <string>
+
+class MemStream : public Stream {
+public:
+	int available() 														{return (int)(in.size() - readPos);}
+	int read() 																	{return readPos < in.size() ? (uint8_t)in[readPos++] : -1;}
+	int peek() 																	{return readPos < in.size() ? (uint8_t)in[readPos] : -1;}
+	size_t write(uint8_t c) 											{writes++; out += (char)c; return 1;}
+	size_t write(const uint8_t* buffer, size_t size) {writes++; out.append((const char*)buffer, size); return size;}
+	using Print::write;
+	int availableForWrite() 											{return writeRoom < 0 ? 256 : writeRoom;}
+	void feed(const std::string& data) 						{in += data;}
+	std::string take() 													{std::string result = out; out.clear(); return result;}
+	int writeRoom = -1;
+	unsigned long writes = 0;
+private:
+	std::string in;
+	std::string out;
+	size_t readPos = 0;
+};
+
+#endif //MemStream_h
@@ -0,0 +1,204 @@
+#include "Arduino.h"
+#include <stdio.h>
+#include <ctype.h>
+#include <chrono>
+
+HostSerial Serial;
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+//==============================================================================================================
+unsigned long millis(){
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+//==============================================================================================================
+unsigned long micros(){
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+//==============================================================================================================
+void delay(unsigned long ms){
+	unsigned long start = millis();
+	while(millis() - start < ms) {}
+}
+//==============================================================================================================
+void yield(){}
+//==============================================================================================================
+String::String(double value, unsigned char decimals){
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+	s = buf;
+}
+//==============================================================================================================
+std::string String::number(unsigned long value, unsigned char base){
+	if(base < 2) base = DEC;
+	char buf[8 * sizeof(long) + 1];
+	char* p = &buf[sizeof(buf) - 1];
+	*p = '\0';
+	do{
+		char digit = value % base;
+		*--p = digit < 10 ? digit + '0' : digit + 'A' - 10;
+		value /= base;
+	}while(value);
+	return p;
+}
+//==============================================================================================================
+std::string String::number(long value, unsigned char base){
+	if(base == DEC && value < 0) return "-" + number(0UL - (unsigned long)value, base);
+	return number((unsigned long)value, base);
+}
+//==============================================================================================================
+int String::indexOf(char c, unsigned int from) const{
+	size_t found = s.find(c, from);
+	return found == std::string::npos ? -1 : (int)found;
+}
+//==============================================================================================================
+int String::indexOf(const String& str, unsigned int from) const{
+	size_t found = s.find(str.s, from);
+	return found == std::string::npos ? -1 : (int)found;
+}
+//==============================================================================================================
+int String::lastIndexOf(char c) const{
+	size_t found = s.rfind(c);
+	return found == std::string::npos ? -1 : (int)found;
+}
+//==============================================================================================================
+String String::substring(unsigned int from, unsigned int to) const{
+	if(from > to){
+		unsigned int tmp = from;
+		from = to;
+		to = tmp;
+	}
+	String result;
+	if(from < s.size()) result.s = s.substr(from, to - from);
+	return result;
+}
+//==============================================================================================================
+void String::replace(const String& find, const String& with){
+	if(find.s.empty()) return;
+	for(size_t at = s.find(find.s); at != std::string::npos; at = s.find(find.s, at + with.s.size())){
+		s.replace(at, find.s.size(), with.s);
+	}
+}
+//==============================================================================================================
+void String::toLowerCase(){
+	for(size_t n = 0; n < s.size(); n++) s[n] = tolower((unsigned char)s[n]);
+}
+//==============================================================================================================
+void String::toUpperCase(){
+	for(size_t n = 0; n < s.size(); n++) s[n] = toupper((unsigned char)s[n]);
+}
+//==============================================================================================================
+void String::trim(){
+	size_t start = 0;
+	while(start < s.size() && isspace((unsigned char)s[start])) start++;
+	size_t end = s.size();
+	while(end > start && isspace((unsigned char)s[end-1])) end--;
+	s = s.substr(start, end - start);
+}
+//==============================================================================================================
+void String::toCharArray(char* buf, unsigned int size) const{
+	if(size == 0) return;
+	size_t length = s.size() < size - 1 ? s.size() : size - 1;
+	memcpy(buf, s.c_str(), length);
+	buf[length] = '\0';
+}
+//==============================================================================================================
+String operator+(const String& a, const String& b) 	{String result = a; result += b; return result;}
+String operator+(const String& a, const char* b) 		{String result = a; result += b; return result;}
+String operator+(const String& a, char b) 						{String result = a; result += b; return result;}
+String operator+(const char* a, const String& b) 		{String result = a; result += b; return result;}
+//==============================================================================================================
+size_t Print::write(const uint8_t* buffer, size_t size){
+	size_t n = 0;
+	while(size--) n += write(*buffer++);
+	return n;
+}
+//==============================================================================================================
+size_t Print::printDigits(unsigned long long value, int base){
+	if(base < 2) base = DEC;
+	char buf[8 * sizeof(long long) + 1];
+	char* p = &buf[sizeof(buf) - 1];
+	*p = '\0';
+	do{
+		char digit = value % base;
+		*--p = digit < 10 ? digit + '0' : digit + 'A' - 10;
+		value /= base;
+	}while(value);
+	return write(p);
+}
+//==============================================================================================================
+size_t Print::print(long value, int base){
+	//other bases print the bits of the long, the same as the AVR core
+	if(base != 0 && base != DEC) return printDigits((unsigned long)value, base);
+	return print((long long)value, base);
+}
+//==============================================================================================================
+size_t Print::print(unsigned long value, int base){
+	return printDigits(value, base);
+}
+//==============================================================================================================
+size_t Print::print(long long value, int base){
+	if(base == 0) return write((uint8_t)value);
+	if(base == DEC && value < 0){
+		size_t n = print('-');
+		return n + printDigits(0ULL - (unsigned long long)value, base);
+	}
+	return printDigits((unsigned long long)value, base);
+}
+//==============================================================================================================
+size_t Print::print(unsigned long long value, int base){
+	if(base == 0) return write((uint8_t)value);
+	return printDigits(value, base);
+}
+//==============================================================================================================
+size_t Print::print(double value, int digits){
+	//the same steps as the AVR core, so the output matches a board
+	if(isnan(value)) return print("nan");
+	if(isinf(value)) return print("inf");
+	if(value > 4294967040.0 || value < -4294967040.0) return print("ovf");
+	size_t n = 0;
+	if(value < 0.0){
+		n += print('-');
+		value = -value;
+	}
+	double rounding = 0.5;
+	for(int i = 0; i < digits; i++) rounding /= 10.0;
+	value += rounding;
+	unsigned long intPart = (unsigned long)value;
+	double remainder = value - (double)intPart;
+	n += print(intPart);
+	if(digits > 0) n += print('.');
+	while(digits-- > 0){
+		remainder *= 10.0;
+		unsigned int digit = (unsigned int)remainder;
+		n += print(digit);
+		remainder -= digit;
+	}
+	return n;
+}
+//==============================================================================================================
+size_t Stream::readBytes(char* buffer, size_t length){
+	size_t count = 0;
+	while(count < length){
+		int c = read();
+		if(c < 0) break;
+		buffer[count++] = (char)c;
+	}
+	return count;
+}
+//==============================================================================================================
+String Stream::readString(){
+	String result;
+	for(int c = read(); c >= 0; c = read()) result += (char)c;
+	return result;
+}
+//==============================================================================================================
+String Stream::readStringUntil(char terminator){
+	String result;
+	for(int c = read(); c >= 0 && c != terminator; c = read()) result += (char)c;
+	return result;
+}
+//==============================================================================================================
+size_t HostSerial::write(uint8_t c){
+	return fputc(c, stdout) == EOF ? 0 : 1;
+}
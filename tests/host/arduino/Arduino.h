@@ -0,0 +1,162 @@
+//Minimal Arduino core for building Commander on a PC
+/*
+Only what Commander, its utilities and the host tests use: Print, Printable, Stream, String,
+millis(), micros(), delay(), yield(), F() and the PROGMEM macros, plus a Serial that writes to stdout.
+Numbers are printed the same way as the AVR core so replies match what a board sends.
+*/
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) ((const __FlashStringHelper*)(s))
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+typedef bool boolean;
+typedef uint8_t byte;
+class __FlashStringHelper;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+class String {
+public:
+	String(const char* str = "") 										: s(str ? str : "") {}
+	String(const __FlashStringHelper* str) 					: s((const char*)str) {}
+	String(char c) 																	: s(1, c) {}
+	String(int value, unsigned char base = DEC) 			: s(number(value, base)) {}
+	String(unsigned int value, unsigned char base = DEC) : s(number(value, base)) {}
+	String(long value, unsigned char base = DEC) 		: s(number(value, base)) {}
+	String(unsigned long value, unsigned char base = DEC) : s(number(value, base)) {}
+	String(double value, unsigned char decimals = 2);
+	unsigned int length() const 										{return s.size();}
+	const char* c_str() const 											{return s.c_str();}
+	bool reserve(unsigned int size) 								{s.reserve(size); return true;}
+	char charAt(unsigned int index) const 						{return index < s.size() ? s[index] : 0;}
+	void setCharAt(unsigned int index, char c) 			{if(index < s.size()) s[index] = c;}
+	char operator[](unsigned int index) const 				{return charAt(index);}
+	char& operator[](unsigned int index) 							{return s[index];}
+	bool concat(const String& str) 									{s += str.s; return true;}
+	bool concat(const char* str) 										{s += str; return true;}
+	bool concat(const char* str, unsigned int length) {s.append(str, length); return true;}
+	bool concat(char c) 															{s += c; return true;}
+	bool concat(int value) 													{s += number(value, DEC); return true;}
+	String& operator+=(const String& str) 						{concat(str); return *this;}
+	String& operator+=(const char* str) 							{concat(str); return *this;}
+	String& operator+=(char c) 											{concat(c); return *this;}
+	String& operator+=(int value) 										{concat(value); return *this;}
+	bool operator==(const String& str) const 				{return s == str.s;}
+	bool operator==(const char* str) const 					{return s == str;}
+	bool operator!=(const String& str) const 				{return s != str.s;}
+	bool operator!=(const char* str) const 					{return s != str;}
+	bool equals(const String& str) const 						{return s == str.s;}
+	int compareTo(const String& str) const 					{return s.compare(str.s);}
+	bool startsWith(const String& str) const 				{return s.compare(0, str.s.size(), str.s) == 0;}
+	bool endsWith(const String& str) const 					{return s.size() >= str.s.size() && s.compare(s.size() - str.s.size(), str.s.size(), str.s) == 0;}
+	int indexOf(char c, unsigned int from = 0) const;
+	int indexOf(const String& str, unsigned int from = 0) const;
+	int lastIndexOf(char c) const;
+	String substring(unsigned int from) const 				{return substring(from, s.size());}
+	String substring(unsigned int from, unsigned int to) const;
+	void remove(unsigned int index) 									{if(index < s.size()) s.erase(index);}
+	void remove(unsigned int index, unsigned int count) {if(index < s.size()) s.erase(index, count);}
+	void replace(const String& find, const String& with);
+	void toLowerCase();
+	void toUpperCase();
+	void trim();
+	long toInt() const 															{return atol(s.c_str());}
+	float toFloat() const 														{return (float)atof(s.c_str());}
+	double toDouble() const 													{return atof(s.c_str());}
+	void toCharArray(char* buf, unsigned int size) const;
+	void getBytes(unsigned char* buf, unsigned int size) const {toCharArray((char*)buf, size);}
+private:
+	static std::string number(unsigned long value, unsigned char base);
+	static std::string number(long value, unsigned char base);
+	static std::string number(unsigned int value, unsigned char base) {return number((unsigned long)value, base);}
+	static std::string number(int value, unsigned char base) 					{return number((long)value, base);}
+	std::string s;
+};
+String operator+(const String& a, const String& b);
+String operator+(const String& a, const char* b);
+String operator+(const String& a, char b);
+String operator+(const char* a, const String& b);
+
+class Print;
+class Printable {
+public:
+	virtual ~Printable() {}
+	virtual size_t printTo(Print& p) const = 0;
+};
+
+class Print {
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t* buffer, size_t size);
+	size_t write(const char* str) 										{return str ? write((const uint8_t*)str, strlen(str)) : 0;}
+	size_t write(const char* buffer, size_t size) 		{return write((const uint8_t*)buffer, size);}
+	virtual int availableForWrite() 									{return 0;}
+	virtual void flush() {}
+	size_t print(const __FlashStringHelper* str) 			{return write((const char*)str);}
+	size_t print(const String& str) 									{return write((const uint8_t*)str.c_str(), str.length());}
+	size_t print(const char* str) 										{return write(str);}
+	size_t print(char c) 															{return write((uint8_t)c);}
+	size_t print(unsigned char value, int base = DEC) {return print((unsigned long)value, base);}
+	size_t print(int value, int base = DEC) 					{return print((long)value, base);}
+	size_t print(unsigned int value, int base = DEC) 	{return print((unsigned long)value, base);}
+	size_t print(long value, int base = DEC);
+	size_t print(unsigned long value, int base = DEC);
+	size_t print(long long value, int base = DEC);
+	size_t print(unsigned long long value, int base = DEC);
+	size_t print(double value, int digits = 2);
+	size_t print(const Printable& p) 									{return p.printTo(*this);}
+	size_t println() 																	{return write("\r\n");}
+	template <class T> size_t println(const T& value) 					{size_t n = print(value); return n + println();}
+	template <class T> size_t println(const T& value, int format) {size_t n = print(value, format); return n + println();}
+	size_t println(const char* str) 									{size_t n = print(str); return n + println();}
+private:
+	size_t printDigits(unsigned long long value, int base);
+};
+
+class Stream : public Print {
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+	void setTimeout(unsigned long) {}
+	size_t readBytes(char* buffer, size_t length);
+	size_t readBytes(uint8_t* buffer, size_t length) 	{return readBytes((char*)buffer, length);}
+	String readString();
+	String readStringUntil(char terminator);
+};
+
+//Serial writes to stdout and never has anything to read
+class HostSerial : public Stream {
+public:
+	void begin(unsigned long) {}
+	operator bool() 																	{return true;}
+	int available() 																	{return 0;}
+	int read() 																				{return -1;}
+	int peek() 																				{return -1;}
+	size_t write(uint8_t c);
+	using Print::write;
+};
+extern HostSerial Serial;
+
+#endif //Arduino_h
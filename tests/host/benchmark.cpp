@@ -0,0 +1,23 @@
+//Runs the Benchmark example on the host
+//The sketch tabs are included here in the order the Arduino IDE joins them, so these prototypes stand in for the ones it generates
+#include <Commander.h>
+
+bool buildCommands(uint16_t tableSize);
+void runTests(uint16_t tableSize);
+unsigned long timeLine(const char* line);
+void makeLine(const char* command, const char* item, uint16_t length);
+void report(const char* test, uint16_t tableSize, unsigned long totalTime);
+bool intsHandler(Commander &Cmdr);
+bool floatsHandler(Commander &Cmdr);
+bool stringsHandler(Commander &Cmdr);
+bool setHandler(Commander &Cmdr);
+bool emptyHandler(Commander &Cmdr);
+extern commandList_t *benchCommands;
+
+#include "../../examples/Benchmark/Benchmark.ino"
+#include "../../examples/Benchmark/benchCommands.ino"
+
+int main(){
+	setup();
+	return 0;
+}
@@ -0,0 +1,12 @@
+# Runs the differential test with and without the item table and fails if the output differs
+# The output is left in differential_table.txt and differential_scan.txt in the build directory
+foreach(name table scan)
+	execute_process(COMMAND ${DIFFERENTIAL} ${name} OUTPUT_FILE ${OUT}/differential_${name}.txt RESULT_VARIABLE result)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "differential ${name} failed: ${result}")
+	endif()
+endforeach()
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${OUT}/differential_table.txt ${OUT}/differential_scan.txt RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "the item table and the buffer search read the payloads differently, compare differential_table.txt and differential_scan.txt in ${OUT}")
+endif()
@@ -0,0 +1,128 @@
+//Differential test for the item table
+/*
+This is run twice, once with the normal item table and once with 'scan', which sets itemTable(0).
+With no item table every getter searches the buffer, which is how they worked before the item table.
+Both runs read the same 20000 random payloads with the getters and print what each handler read.
+differential.cmake runs both and checks that the output is the same.
+*/
+#include <Commander.h>
+#include "MemStream.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PAYLOADS 		20000
+#define MAX_TOKENS 	45 //more than COMMANDER_MAX_ITEMS so long payloads overflow the table in the normal run too
+
+static String readLog;
+
+//==============================================================================================================
+//Handlers that read the payload in different ways
+static bool intsHandler(Commander &Cmdr){
+	int value = 0;
+	while(Cmdr.getInt(value)) readLog += String(value) + ":" + String(Cmdr.parseError()) + " ";
+	return 0;
+}
+static bool floatsHandler(Commander &Cmdr){
+	float value = 0;
+	while(Cmdr.getFloat(value)) readLog += String(value, 4) + ":" + String(Cmdr.parseError()) + " ";
+	return 0;
+}
+static bool stringsHandler(Commander &Cmdr){
+	String value;
+	while(Cmdr.getString(value)) readLog += "[" + value + "] ";
+	return 0;
+}
+static bool mixedHandler(Commander &Cmdr){
+	//read a mix of types, then count what is left, then start again
+	int intValue = 0;
+	float floatValue = 0;
+	String stringValue;
+	readLog += "count " + String(Cmdr.countItems()) + " ";
+	for(uint8_t n = 0; n < 6; n++){
+		if(n % 3 == 0 && Cmdr.getInt(intValue)) 				readLog += "i" + String(intValue) + " ";
+		else if(n % 3 == 1 && Cmdr.getFloat(floatValue)) readLog += "f" + String(floatValue, 4) + " ";
+		else if(Cmdr.getString(stringValue)) 						readLog += "s[" + stringValue + "] ";
+	}
+	readLog += "left " + String(Cmdr.countItems()) + " ";
+	Cmdr.rewind();
+	if(Cmdr.getString(stringValue)) readLog += "first[" + stringValue + "] ";
+	return 0;
+}
+static bool keysHandler(Commander &Cmdr){
+	int x = -1;
+	float speed = -1;
+	String name = "-";
+	readLog += "x" + String(Cmdr.quickSet("x", x)) + "=" + String(x) + " ";
+	readLog += "speed" + String(Cmdr.quickSet("speed", speed)) + "=" + String(speed, 4) + " ";
+	readLog += "name" + String(Cmdr.quickSet("name", name)) + "=" + name + " ";
+	readLog += "max" + String(Cmdr.quick("max")) + " ";
+	readLog += "on" + String(Cmdr.containsOn()) + " off" + String(Cmdr.containsOff()) + " ";
+	return 0;
+}
+static bool arraysHandler(Commander &Cmdr){
+	int16_t ints[40];
+	int16_t badItem = -1;
+	uint16_t count = Cmdr.getInts(ints, 40, &badItem);
+	readLog += "ints " + String(count) + " bad " + String(badItem) + " ";
+	for(uint16_t n = 0; n < count; n++) readLog += String(ints[n]) + " ";
+	Cmdr.rewind();
+	float floats[40];
+	count = Cmdr.getFloats(floats, 40, &badItem);
+	readLog += "floats " + String(count) + " bad " + String(badItem) + " ";
+	for(uint16_t n = 0; n < count; n++) readLog += String(floats[n], 4) + " ";
+	return 0;
+}
+static const commandList_t commands[] = {
+	{"ints", intsHandler, ""}, {"floats", floatsHandler, ""}, {"strings", stringsHandler, ""},
+	{"mixed", mixedHandler, ""}, {"keys", keysHandler, ""}, {"arrays", arraysHandler, ""}
+};
+
+//==============================================================================================================
+//Random payloads from a fixed seed, so both builds see the same lines
+static uint32_t randomState = 0x2545F491;
+static uint32_t randomNumber(uint32_t range){
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState % range;
+}
+
+static const char* words[] = {"x", "speed", "name", "on", "off", "max", "hello", "true", "\"a b\"", "\"x\"", "5k", "-", "+.", "1e", "--3", "0x", "12abc"};
+static const char* separators[] = {" ", "  ", "=", ",", ":", "\t", " , ", " = ", "|"};
+
+static String randomToken(){
+	switch(randomNumber(6)){
+		case 0: 	return String((long)randomNumber(100000) - 50000);
+		case 1: 	return String((long)randomNumber(2000) - 1000) + "." + String((long)randomNumber(1000));
+		case 2: 	return String((long)randomNumber(100)) + (randomNumber(2) ? "e" : "E") + String((long)randomNumber(10) - 5);
+		case 3: 	return "0x" + String((long)randomNumber(0x10000), HEX);
+		case 4: 	return "99999999999";
+		default: 	return words[randomNumber(sizeof(words)/sizeof(words[0]))];
+	}
+}
+
+static String randomLine(){
+	String line = commands[randomNumber(sizeof(commands)/sizeof(commands[0]))].commandString;
+	uint32_t tokens = randomNumber(MAX_TOKENS + 1);
+	for(uint32_t n = 0; n < tokens; n++) line += separators[randomNumber(sizeof(separators)/sizeof(separators[0]))] + randomToken();
+	if(randomNumber(4) == 0) line += separators[randomNumber(sizeof(separators)/sizeof(separators[0]))];
+	return line + "\n";
+}
+
+//==============================================================================================================
+int main(int argc, char* argv[]){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, commands, sizeof(commands)).setBuffer(512);
+	if(argc > 1 && strcmp(argv[1], "scan") == 0) cmd.itemTable(0);
+	for(uint32_t n = 0; n < PAYLOADS; n++){
+		String line = randomLine();
+		readLog = "";
+		port.feed(line.c_str());
+		while(cmd.update());
+		cmd.update();
+		std::string reply = port.take();
+		printf("%s%s\n%s\n", line.c_str(), readLog.c_str(), reply.c_str());
+	}
+	return 0;
+}
@@ -0,0 +1,732 @@
+//Regression tests for Commander, run on the host with the Arduino shim
+#include <Commander.h>
+#include "MemStream.h"
+#include "HostTest.h"
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+//run update() until everything fed to the port has been handled
+static void run(Commander &cmd, uint16_t updates = 50){
+	for(uint16_t n = 0; n < updates; n++) cmd.update();
+}
+
+//==============================================================================================================
+//A handler that switches command tables must not record its time in the new table's stats
+static bool statsHit(Commander&) 		{return 0;}
+static bool statsBack(Commander &Cmdr);
+static const commandList_t statsSmall[] = {{"back", statsBack, ""}};
+static bool statsSwitch(Commander &Cmdr) 	{Cmdr.attachCommands(statsSmall, sizeof(statsSmall)); return 0;}
+static const commandList_t statsBig[] = {
+	{"a", statsHit, ""}, {"b", statsHit, ""}, {"c", statsHit, ""}, {"d", statsHit, ""}, {"switch", statsSwitch, ""}, {"f", statsHit, ""}
+};
+static bool statsBack(Commander &Cmdr) 		{Cmdr.attachCommands(statsBig, sizeof(statsBig)); return 0;}
+
+TEST(statsAreKeptPerTable){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, statsBig, sizeof(statsBig));
+	cmd.commandStats(true);
+	port.feed("a\nf\nswitch\nback\nswitch\nback\na\n");
+	run(cmd);
+	CHECK(cmd.getCommandStats(0) != NULL);
+	CHECK_EQUAL(2, cmd.getCommandStats(0)->hits);
+	CHECK_EQUAL(1, cmd.getCommandStats(5)->hits);
+	CHECK_EQUAL(0, cmd.getCommandStats(4)->hits); //switch changed the table so it isn't recorded
+	CHECK(cmd.getCommandStats(6) == NULL);
+}
+
+//==============================================================================================================
+//quick() returns 0 when the key isn't in the payload
+static String quickFound;
+static bool quickHandler(Commander &Cmdr){
+	if(Cmdr.quick("int1")) quickFound += "int1 ";
+	if(Cmdr.quick("hello")) quickFound += "hello ";
+	return 0;
+}
+static const commandList_t quickCommands[] = {{"print", quickHandler, ""}};
+
+TEST(quickOnlyMatchesKeysInThePayload){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, quickCommands, sizeof(quickCommands));
+	port.feed("print hello\nprint\nprint hello2\n");
+	run(cmd);
+	CHECK_EQUAL("hello ", quickFound.c_str());
+}
+
+//==============================================================================================================
+//numbers with a fraction, exponent or suffix are not opcodes
+static String opcodeLog;
+static bool opcodeHandler(Commander &Cmdr) 	{opcodeLog += String(Cmdr.getOpcode()) + " "; return 0;}
+static bool opcodeSpecial(Commander &Cmdr) 	{opcodeLog += "special "; (void)Cmdr; return 0;}
+static const commandList_t opcodeCommands[] = {{"hello", statsHit, ""}};
+static const opcodeList_t opcodes[] = {{1, opcodeHandler, ""}, {2, opcodeHandler, ""}, {10, opcodeHandler, ""}, {12, opcodeHandler, ""}};
+
+TEST(opcodesMustBeWholeIntegers){
+	MemStream port;
+	Commander cmd;
+	OpcodeTable table(opcodes, sizeof(opcodes));
+	cmd.begin(&port, opcodeCommands, sizeof(opcodeCommands));
+	cmd.attachSpecialHandler(opcodeSpecial);
+	cmd.attachOpcodes(table);
+	port.feed("12\n12.5\n1e1\n2.0 4\n0x2\n10 5\n");
+	run(cmd);
+	CHECK_EQUAL("12 special special special 2 10 ", opcodeLog.c_str());
+}
+
+//==============================================================================================================
+//getInt() reads whole numbers only, clamps overflow and only takes suffixes when they are enabled
+static String intLog;
+static bool intHandler(Commander &Cmdr){
+	int value = 0;
+	while(Cmdr.getInt(value)) intLog += String(value) + ":" + String(Cmdr.parseError()) + " ";
+	return 0;
+}
+static bool int8Handler(Commander &Cmdr){
+	int8_t value = 0;
+	while(Cmdr.getInt(value)) intLog += String(value) + ":" + String(Cmdr.parseError()) + " ";
+	return 0;
+}
+static const commandList_t intCommands[] = {{"int", intHandler, ""}, {"int8", int8Handler, ""}};
+
+TEST(getIntReadsWholeNumbers){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, intCommands, sizeof(intCommands));
+	port.feed("int 10m 1e3 2.7 42 0x1F\n");
+	run(cmd);
+	CHECK_EQUAL("10:3 1:3 2:3 42:0 31:0 ", intLog.c_str());
+	intLog = "";
+	port.feed("int 99999999999 -99999999999\nint8 127 128 -129\n");
+	run(cmd);
+	CHECK_EQUAL("2147483647:2 -2147483648:2 127:0 127:2 -128:2 ", intLog.c_str());
+	intLog = "";
+	cmd.engineeringSuffixes(true);
+	port.feed("int 5k 2M 10m\n");
+	run(cmd);
+	CHECK_EQUAL("5000:0 2000000:0 10:3 ", intLog.c_str());
+}
+
+//==============================================================================================================
+//the transmit queue only sends what availableForWrite() says the port can take, or DEFAULT_TX_CHUNK if it says 0
+static bool longReply(Commander &Cmdr) 	{Cmdr.println("0123456789012345678901234567890123456789"); return 0;}
+static const commandList_t queueCommands[] = {{"long", longReply, ""}};
+
+TEST(transmitQueueSendsWhatThePortCanTake){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, queueCommands, sizeof(queueCommands));
+	cmd.transmitQueue(true, 256);
+	port.writeRoom = 10;
+	port.feed("long\n");
+	cmd.update();
+	std::string sent = port.take();
+	CHECK(sent.size() <= 10);
+	port.writeRoom = 0;
+	cmd.update();
+	std::string chunk = port.take();
+	CHECK(!chunk.empty() && chunk.size() <= DEFAULT_TX_CHUNK);
+	sent += chunk;
+	run(cmd);
+	sent += port.take();
+	CHECK_EQUAL("0123456789012345678901234567890123456789\r\n", sent);
+}
+
+//==============================================================================================================
+//runScript() ends when the source has nothing available, unless it is given an idle timeout
+class SlowStream : public MemStream {
+public:
+	//nothing is available until the first few calls to available() have gone by, like a port the script hasn't arrived at yet
+	int available() 		{return gaps > 0 ? (gaps--, 0) : MemStream::available();}
+	int gaps = 0;
+};
+
+TEST(runScriptWaitsForSlowSources){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, statsBig, sizeof(statsBig));
+	SlowStream script;
+	script.feed("a\nb\nunknown\nc");
+	scriptResult_t result = cmd.runScript(script);
+	CHECK_EQUAL(4, result.lines);
+	CHECK_EQUAL(1, result.errors);
+	CHECK_EQUAL(3, result.firstError);
+	SlowStream slow;
+	slow.feed("a\nb\n");
+	slow.gaps = 3;
+	result = cmd.runScript(slow);
+	CHECK_EQUAL(0, result.lines);
+	slow.gaps = 3;
+	result = cmd.runScript(slow, false, 20);
+	CHECK_EQUAL(2, result.lines);
+}
+
+//==============================================================================================================
+//binary frames are not echoed, text lines either side of them still are
+static std::string frameRequest(uint8_t commandID){
+	uint8_t header[2] = {0, commandID};
+	uint16_t crc = frameCRC(FRAME_CRC_INIT, header, 2);
+	std::string frame = {(char)FRAME_START, 0, (char)commandID, (char)crc, (char)(crc >> 8)};
+	return frame;
+}
+
+static std::string frameOutput(bool echo, bool bulk, const std::string &input){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, statsBig, sizeof(statsBig));
+	cmd.binaryFrames(true).echo(echo).bulkRead(bulk);
+	port.feed(input);
+	run(cmd);
+	return port.take();
+}
+
+TEST(binaryFramesAreNotEchoed){
+	std::string frame = frameRequest(0);
+	for(int bulk = 0; bulk < 2; bulk++){
+		CHECK_EQUAL(frameOutput(false, bulk, frame), frameOutput(true, bulk, frame));
+		CHECK_EQUAL("a\n" + frameOutput(false, bulk, frame) + "b\n", frameOutput(true, bulk, "a\n" + frame + "b\n"));
+	}
+}
+
+//==============================================================================================================
+//adding single characters reuses the room left at the front when characters are removed from the start
+TEST(bufferReusesTheFrontForCharacters){
+	CommandBuffer buffer;
+	buffer.setCapacity(8);
+	buffer += "abcdefgh";
+	buffer.remove(0, 4);
+	CHECK(buffer.concat('1'));
+	CHECK(buffer.concat('2'));
+	buffer += "34";
+	CHECK_EQUAL("efgh1234", buffer.c_str());
+	CHECK(!buffer.concat('5'));
+	CHECK_EQUAL("efgh1234", buffer.c_str());
+}
+
+//==============================================================================================================
+//feedString() and loadString() drop strings that don't fit in the buffer instead of handling part of them
+static String loadLog;
+static bool loadHandler(Commander &Cmdr){
+	String value;
+	while(Cmdr.getString(value)) loadLog += value + " ";
+	return 0;
+}
+static const commandList_t loadCommands[] = {{"set", loadHandler, ""}};
+
+TEST(feedStringDropsStringsThatDontFit){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, loadCommands, sizeof(loadCommands)).setBuffer(16);
+	CHECK(!cmd.feedString("set 1234567890123"));
+	CHECK(cmd.stringOverflow());
+	CHECK_EQUAL("", loadLog.c_str());
+	CHECK(cmd.feedString("set 12345678901"));
+	CHECK(!cmd.stringOverflow());
+	CHECK_EQUAL("12345678901 ", loadLog.c_str());
+	loadLog = "";
+	cmd.loadString("set 123456789012345");
+	run(cmd);
+	CHECK(cmd.stringOverflow());
+	CHECK_EQUAL("", loadLog.c_str());
+	cmd.loadString("set 99\n");
+	run(cmd);
+	CHECK_EQUAL("99 ", loadLog.c_str());
+}
+
+//==============================================================================================================
+//getDouble() is correctly rounded - it reads every number the same as strtod(), including shortest numbers and halfway cases
+static std::vector<double> doublesRead;
+static bool doublesHandler(Commander &Cmdr){
+	double value = 0;
+	while(Cmdr.getDouble(value)) doublesRead.push_back(value);
+	return 0;
+}
+static const commandList_t doubleCommands[] = {{"d", doublesHandler, ""}};
+
+static uint64_t doubleRandomState = 88172645463325252ULL;
+static uint64_t randomBits(){
+	doubleRandomState ^= doubleRandomState << 13;
+	doubleRandomState ^= doubleRandomState >> 7;
+	doubleRandomState ^= doubleRandomState << 17;
+	return doubleRandomState;
+}
+
+static void checkDoubles(Commander &cmd, MemStream &port, const std::vector<std::string> &numbers, size_t perLine){
+	//send the numbers a few to a line and check each one against strtod
+	for(size_t first = 0; first < numbers.size(); first += perLine){
+		std::string line = "d";
+		size_t last = first + perLine < numbers.size() ? first + perLine : numbers.size();
+		for(size_t n = first; n < last; n++) line += " " + numbers[n];
+		doublesRead.clear();
+		port.feed(line + "\n");
+		run(cmd, 3);
+		CHECK_EQUAL(last - first, doublesRead.size());
+		for(size_t n = first; n < last && n - first < doublesRead.size(); n++){
+			double expected = strtod(numbers[n].c_str(), NULL);
+			if(memcmp(&expected, &doublesRead[n - first], sizeof(double)) != 0) CHECK_EQUAL(numbers[n], String(doublesRead[n - first], 20).c_str());
+		}
+	}
+}
+
+TEST(getDoubleIsCorrectlyRounded){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, doubleCommands, sizeof(doubleCommands)).setBuffer(2048);
+	std::vector<std::string> numbers = {
+		"10074.480630311615", "9007199254740993", "9007199254740995", "2.2250738585072011e-308", "4.9406564584124654e-324",
+		"2.4703282292062327e-324", "2.4703282292062328e-324", "1.7976931348623157e308", "1.7976931348623158e308", "1e-400",
+		"0.1000000000000000055511151231257827021181583404541015625", "9007199254740993.00000000000000000000000000000001",
+		"123456789012345678901234567890e-340", "0.000000000000000000000000000000000000000000001e-300", "1.5e300", "-0.0"
+	};
+	char text[NUMBER_BUFFER_SIZE];
+	for(uint32_t n = 0; n < 20000; n++){
+		//any double from its bits, and moderate values like calibration constants
+		uint64_t bits = randomBits();
+		double value;
+		memcpy(&value, &bits, sizeof(double));
+		if(value == value && value - value == 0){
+			formatShortest(text, value);
+			numbers.push_back(text);
+		}
+		formatShortest(text, (double)(randomBits() % 100000000) / (double)(1 + randomBits() % 100000));
+		numbers.push_back(text);
+	}
+	checkDoubles(cmd, port, numbers, 8);
+	//long digit strings that sit exactly on, or just past, the halfway point between two doubles
+	numbers.clear();
+	for(uint32_t n = 0; n < 200; n++){
+		uint64_t bits = randomBits() & 0x7FEFFFFFFFFFFFFFULL;
+		double low;
+		memcpy(&low, &bits, sizeof(double));
+		char halfway[1200];
+		snprintf(halfway, sizeof(halfway), "%.1100Le", ((long double)low + (long double)nextafter(low, DBL_MAX)) / 2);
+		numbers.push_back(halfway);
+		std::string justAbove = halfway;
+		justAbove.insert(justAbove.find('e'), "1");
+		numbers.push_back(justAbove);
+	}
+	checkDoubles(cmd, port, numbers, 1);
+}
+
+//==============================================================================================================
+//float and double variables printed by get read back through set as exactly the same value
+static double roundTripDouble = 0;
+static float roundTripFloat = 0;
+static const variableList_t roundTripVariables[] = {{"x", VAR_DOUBLE, &roundTripDouble, 0, 0}, {"f", VAR_FLOAT, &roundTripFloat, 0, 0}};
+
+TEST(variablesReadBackExactly){
+	MemStream port;
+	Commander cmd;
+	VariableTable variables(roundTripVariables, sizeof(roundTripVariables));
+	cmd.begin(&port, doubleCommands, sizeof(doubleCommands)).attachVariables(variables).commandPrompt(OFF);
+	for(uint32_t n = 0; n < 5000; n++){
+		uint64_t bits = randomBits();
+		double value;
+		memcpy(&value, &bits, sizeof(double));
+		if(value != value || value - value != 0) continue;
+		uint32_t floatBits = (uint32_t)randomBits();
+		float floatValue;
+		memcpy(&floatValue, &floatBits, sizeof(float));
+		if(floatValue != floatValue || floatValue - floatValue != 0) floatValue = (float)(randomBits() % 100000) / 7.0f;
+		roundTripDouble = value;
+		roundTripFloat = floatValue;
+		port.feed("get x f\n");
+		run(cmd, 3);
+		std::string reply = port.take();
+		//turn 'x=1.5\r\nf=2\r\n' into 'set x 1.5 f 2'
+		std::string line = "set ";
+		for(char ch : reply) line += ch == '=' || ch == '\r' || ch == '\n' ? ' ' : ch;
+		roundTripDouble = 0;
+		roundTripFloat = 0;
+		port.feed(line + "\n");
+		run(cmd, 3);
+		port.take();
+		if(memcmp(&value, &roundTripDouble, sizeof(double)) != 0 || memcmp(&floatValue, &roundTripFloat, sizeof(float)) != 0) CHECK_EQUAL("", reply);
+	}
+}
+
+//==============================================================================================================
+//help and transfers handle their payload as a command, and the rest of a line split by a separator still runs after it
+static String chainLog;
+static bool chainX(Commander&) 				{chainLog += "x "; return 0;}
+static bool chainLong(Commander&) 		{chainLog += "abcdefgh "; return 0;}
+static bool chainTransfer(Commander &Cmdr);
+static const commandList_t chainCommands[] = {{"x", chainX, ""}, {"abcdefgh", chainLong, ""}, {"go", chainTransfer, ""}};
+static const char* chainHelp[] = {"x help", "abcdefgh help", "go help"};
+static bool chainTransfer(Commander &Cmdr){
+	chainLog += "go ";
+	Cmdr.transferTo(chainCommands, sizeof(chainCommands), "chain");
+	return 0;
+}
+
+TEST(payloadCommandsKeepTheRestOfTheLine){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, chainCommands, sizeof(chainCommands)).setExtraHelp(chainHelp).separatorChar(';').commandPrompt(OFF);
+	port.feed("help x;abcdefgh\n");
+	run(cmd, 3);
+	CHECK_EQUAL("abcdefgh ", chainLog.c_str());
+	CHECK(port.take().find("x help") != std::string::npos);
+	chainLog = "";
+	port.feed("go x;abcdefgh\n");
+	run(cmd, 3);
+	CHECK_EQUAL("go x abcdefgh ", chainLog.c_str());
+	chainLog = "";
+	port.feed("help;abcdefgh\n");
+	run(cmd, 3);
+	CHECK_EQUAL("abcdefgh ", chainLog.c_str());
+	std::string reply = port.take();
+	CHECK(reply.find("User Commands") != std::string::npos);
+	CHECK(reply.find("abcdefgh help") == std::string::npos);
+}
+
+//==============================================================================================================
+//lines left in the read block are still handled after bulkRead is turned off
+static String bulkLog;
+static bool bulkA(Commander&) 	{bulkLog += "a "; return 0;}
+static bool bulkB(Commander&) 	{bulkLog += "b "; return 0;}
+static const commandList_t bulkCommands[] = {{"a", bulkA, ""}, {"b", bulkB, ""}};
+
+TEST(bulkReadOffKeepsTheBlock){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, bulkCommands, sizeof(bulkCommands)).bulkRead(ON).echo(true).commandPrompt(OFF);
+	port.feed("a\nb\na\n");
+	cmd.update();
+	CHECK_EQUAL("a ", bulkLog.c_str());
+	cmd.bulkRead(OFF);
+	port.feed("b\n");
+	uint16_t updates = 0;
+	while(cmd.update() && updates < 100) updates++;
+	CHECK(updates < 100);
+	CHECK_EQUAL("a b a b ", bulkLog.c_str());
+	CHECK_EQUAL("a\nb\na\nb\n", port.take());
+}
+
+//==============================================================================================================
+//objects share the default delimiter map, so changing the delimiters of one doesn't change the others
+static String delimiterLog;
+static bool delimiterHandler(Commander &Cmdr){
+	String item;
+	while(Cmdr.getString(item)) delimiterLog += "[" + item + "]";
+	delimiterLog += " ";
+	return 0;
+}
+static const commandList_t delimiterCommands[] = {{"items", delimiterHandler, ""}};
+
+TEST(delimitersArePerObject){
+	MemStream portA, portB;
+	Commander cmdA, cmdB;
+	cmdA.begin(&portA, delimiterCommands, sizeof(delimiterCommands)).itemTable(2);
+	cmdB.begin(&portB, delimiterCommands, sizeof(delimiterCommands)).itemTable(0);
+	cmdA.delimiters(" ;");
+	portA.feed("items a;b,c d\n");
+	portB.feed("items a;b,c d\n");
+	run(cmdA, 3);
+	run(cmdB, 3);
+	CHECK_EQUAL("[a][b,c][d] [a;b][c][d] ", delimiterLog.c_str());
+	delimiterLog = "";
+	cmdA.delimiters(DEFAULT_DELIMITERS);
+	portA.feed("items a;b,c d\n");
+	run(cmdA, 3);
+	CHECK_EQUAL("[a;b][c][d] ", delimiterLog.c_str());
+}
+
+//==============================================================================================================
+//a watch period of 0 is raised to MIN_WATCH_PERIOD so it can't flood the port
+static int watchedInt = 0;
+static float watchedFloat = 0;
+static const variableList_t watchedVariables[] = {{"speed", VAR_INT, &watchedInt, 0, 0}, {"gain", VAR_FLOAT, &watchedFloat, 0, 0}};
+
+static uint16_t countLines(const std::string &text, const char* start){
+	//count the lines in text that start with start
+	uint16_t count = 0;
+	size_t lineStart = 0;
+	while(lineStart < text.size()){
+		if(text.compare(lineStart, strlen(start), start) == 0) count++;
+		size_t end = text.find('\n', lineStart);
+		if(end == std::string::npos) break;
+		lineStart = end + 1;
+	}
+	return count;
+}
+
+TEST(watchPeriodHasAMinimum){
+	MemStream port;
+	Commander cmd;
+	VariableTable variables(watchedVariables, sizeof(watchedVariables));
+	cmd.begin(&port, doubleCommands, sizeof(doubleCommands)).attachVariables(variables).commandPrompt(OFF);
+	port.feed("watch speed 0\n");
+	cmd.update();
+	CHECK(port.take().find("#Watch: period raised to 10ms") != std::string::npos);
+	unsigned long start = millis();
+	for(uint8_t n = 0; n < 50; n++){
+		cmd.update();
+		delay(1);
+	}
+	unsigned long elapsed = millis() - start;
+	uint16_t samples = countLines(port.take(), "speed=");
+	CHECK(samples >= 2 && samples <= elapsed / MIN_WATCH_PERIOD + 2);
+	cmd.unwatchAll();
+	CHECK(cmd.watchVariable("gain", 0));
+	port.feed("watch\n");
+	run(cmd, 3);
+	CHECK(port.take().find("gain 10\r\n") != std::string::npos);
+}
+
+//==============================================================================================================
+//commands are matched while the line arrives, and that has to pick the same command as searching the finished line
+static String matchLog;
+static bool matchHandler(Commander &Cmdr) 	{matchLog += String(Cmdr.getCommandList()[Cmdr.getCommandIndex()].commandString) + "|"; return 0;}
+static bool matchUnknown(Commander&) 				{matchLog += "?|"; return 0;}
+static const commandList_t matchCommands[] = {
+	{"set", matchHandler, ""}, {"set speed", matchHandler, ""}, {"set speed max", matchHandler, ""}, {"se", matchHandler, ""},
+	{"s", matchHandler, ""}, {"setspeed", matchHandler, ""}, {"reset", matchHandler, ""}, {"a", matchHandler, ""},
+	{"ab", matchHandler, ""}, {"abc", matchHandler, ""}, {"b c", matchHandler, ""}
+};
+static const commandList_t matchOther[] = {{"set", matchHandler, ""}, {"set sp", matchHandler, ""}, {"speed", matchHandler, ""}};
+
+static String matchByPort(Commander &cmd, MemStream &port, const std::string &line){
+	matchLog = "";
+	port.feed(line);
+	run(cmd, 3);
+	port.take();
+	return matchLog;
+}
+
+TEST(trackedMatchesAgreeWithTheSearch){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, matchCommands, sizeof(matchCommands)).attachDefaultHandler(matchUnknown).commandPrompt(OFF).errorMessages(OFF);
+	//the longest command wins, and it has to end at a delimiter or the end of the line
+	CHECK_EQUAL("set|", matchByPort(cmd, port, "set\n").c_str());
+	CHECK_EQUAL("set speed|", matchByPort(cmd, port, "set speed 5\n").c_str());
+	CHECK_EQUAL("set|", matchByPort(cmd, port, "set speedy 5\n").c_str());
+	CHECK_EQUAL("set speed max|", matchByPort(cmd, port, "set speed max=5\n").c_str());
+	CHECK_EQUAL("setspeed|", matchByPort(cmd, port, "setspeed\n").c_str());
+	CHECK_EQUAL("se|", matchByPort(cmd, port, "se,1\n").c_str());
+	CHECK_EQUAL("?|", matchByPort(cmd, port, "sets\n").c_str());
+	//the reload char is a delimiter part way through a line, and reloads the last line at the start of one
+	CHECK_EQUAL("set|", matchByPort(cmd, port, "set/5\n").c_str());
+	CHECK_EQUAL("set speed|", matchByPort(cmd, port, "set speed 5\n").c_str());
+	CHECK_EQUAL("set speed|", matchByPort(cmd, port, "/").c_str());
+	//the command list changes part way through a line, the match is made against the new list
+	port.feed("set spe");
+	run(cmd, 3);
+	cmd.attachCommands(matchOther, sizeof(matchOther));
+	CHECK_EQUAL("set|", matchByPort(cmd, port, "ed 5\n").c_str());
+	port.feed("set s");
+	run(cmd, 3);
+	cmd.attachCommands(matchCommands, sizeof(matchCommands));
+	CHECK_EQUAL("set speed|", matchByPort(cmd, port, "peed 5\n").c_str());
+	//random lines give the same command when they arrive from the port as when they are searched with feedString()
+	static const char* words[] = {"set", "speed", "max", "se", "s", "setspeed", "reset", "a", "ab", "abc", "b", "c", "x", "5"};
+	static const char* delimiters[] = {" ", "=", "/", ",", ":", "  ", " = ", ""};
+	uint16_t mismatches = 0;
+	for(uint16_t n = 0; n < 5000; n++){
+		std::string line = words[randomBits() % (sizeof(words)/sizeof(words[0]))];
+		uint8_t extra = randomBits() % 4;
+		for(uint8_t w = 0; w < extra; w++){
+			line += delimiters[randomBits() % (sizeof(delimiters)/sizeof(delimiters[0]))];
+			line += words[randomBits() % (sizeof(words)/sizeof(words[0]))];
+		}
+		if(line.size() < 2) continue; //feedString() ignores lines this short
+		String tracked = matchByPort(cmd, port, line + "\n");
+		matchLog = "";
+		cmd.feedString(line.c_str());
+		port.take();
+		if(tracked != matchLog && mismatches++ < 5) CHECK_EQUAL((line + " " + matchLog.c_str()).c_str(), (line + " " + tracked.c_str()).c_str());
+	}
+	CHECK_EQUAL(0, mismatches);
+}
+
+//==============================================================================================================
+//update(budgetMicros) finishes the line it is on when the budget runs out and leaves the rest for the next call
+static String budgetLog;
+static bool budgetFast(Commander&) 	{budgetLog += "f"; return 0;}
+static bool budgetSlow(Commander&) 	{budgetLog += "s"; delay(2); return 0;}
+static const commandList_t budgetCommands[] = {{"fast", budgetFast, ""}, {"slow", budgetSlow, ""}};
+
+TEST(updateBudgetLeavesLinesForLater){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, budgetCommands, sizeof(budgetCommands)).commandPrompt(OFF);
+	//a budget of 0 handles one line, the same as update()
+	port.feed("fast\nfast\nfast\n");
+	CHECK(cmd.update(0));
+	CHECK_EQUAL(1, cmd.commandsRun());
+	CHECK(cmd.update());
+	CHECK_EQUAL(1, cmd.commandsRun());
+	CHECK(!cmd.update(0));
+	CHECK_EQUAL("fff", budgetLog.c_str());
+	//a slow line uses up the budget, so the lines after it wait for the next update
+	budgetLog = "";
+	port.feed("slow\nfast\nslow\nfast\n");
+	CHECK(cmd.update(1000));
+	CHECK_EQUAL(1, cmd.commandsRun());
+	CHECK_EQUAL("s", budgetLog.c_str());
+	CHECK(cmd.update(1000));
+	CHECK_EQUAL(2, cmd.commandsRun());
+	CHECK_EQUAL("sfs", budgetLog.c_str());
+	//a big budget handles everything that is left and says there is nothing more to do
+	CHECK(!cmd.update(1000000));
+	CHECK_EQUAL(1, cmd.commandsRun());
+	CHECK_EQUAL("sfsf", budgetLog.c_str());
+	port.feed("fast\nfast\nfast\n");
+	CHECK(!cmd.update(1000000));
+	CHECK_EQUAL(3, cmd.commandsRun());
+}
+
+//==============================================================================================================
+//a stream handler gets the stream in order, in full chunks, and the chunk it had last time is left alone while the next one fills
+static std::string streamReceived;
+static std::vector<uint16_t> streamChunks;
+static const uint8_t* streamLastChunk = NULL;
+static std::string streamLastCopy;
+static bool streamKeptLastChunk = true;
+static bool streamEnded = false;
+static bool streamChunk(Commander &Cmdr, const uint8_t* data, size_t length){
+	if(streamLastChunk){
+		if(data == streamLastChunk || streamLastCopy.compare(0, std::string::npos, (const char*)streamLastChunk, streamLastCopy.size()) != 0) streamKeptLastChunk = false;
+	}
+	streamReceived.append((const char*)data, length);
+	streamChunks.push_back(length);
+	streamLastChunk = data;
+	streamLastCopy.assign((const char*)data, length);
+	if(!Cmdr.isStreaming()) streamEnded = true;
+	return 0;
+}
+static bool streamStart(Commander &Cmdr) 	{Cmdr.startStreaming(); return 0;}
+static bool streamAfter(Commander&) 			{streamReceived += "|after"; return 0;}
+static const commandList_t streamCommands[] = {{"upload", streamStart, ""}, {"after", streamAfter, ""}};
+
+TEST(streamChunksArriveInOrder){
+	MemStream port;
+	Commander cmd;
+	cmd.begin(&port, streamCommands, sizeof(streamCommands)).attachStreamHandler(streamChunk, 16).commandPrompt(OFF);
+	std::string payload;
+	for(uint16_t n = 0; n < 200; n++) payload += (char)(n % 4 == 3 ? '\n' : 'a' + n % 26);
+	//arrives in uneven pieces, with a gap long enough to pass a part filled chunk
+	port.feed("upload\n" + payload.substr(0, 5));
+	run(cmd, 3);
+	delay(STREAM_IDLE_TIME + 5);
+	run(cmd, 3);
+	for(size_t start = 5; start < payload.size(); start += 23){
+		port.feed(payload.substr(start, 23));
+		cmd.update();
+	}
+	port.feed("\x04\nafter\n");
+	run(cmd, 10);
+	CHECK_EQUAL(payload + "|after", streamReceived);
+	CHECK(streamEnded);
+	CHECK(streamKeptLastChunk);
+	CHECK(streamChunks.size() > 2);
+	CHECK_EQUAL(5, streamChunks[0]);
+	for(size_t n = 1; n + 1 < streamChunks.size(); n++) CHECK_EQUAL(16, streamChunks[n]);
+	CHECK(!cmd.isStreaming());
+}
+
+//==============================================================================================================
+//get, set and dump for each type of variable, names that aren't in the table and values outside the range
+static int tableInt = 0;
+static float tableFloat = 0;
+static double tableDouble = 0;
+static bool tableBool = false;
+static String tableString = "";
+static const variableList_t tableVariables[] = {
+	{"count", VAR_INT, &tableInt, -10, 100}, {"gain", VAR_FLOAT, &tableFloat, 0, 2}, {"offset", VAR_DOUBLE, &tableDouble, 0, 0},
+	{"enabled", VAR_BOOL, &tableBool, 0, 0}, {"name", VAR_STRING, &tableString, 0, 0}
+};
+
+static std::string variableReply(Commander &cmd, MemStream &port, const std::string &line){
+	port.feed(line + "\n");
+	run(cmd, 3);
+	return port.take();
+}
+
+TEST(variableCommandsReadAndWriteEachType){
+	MemStream port;
+	Commander cmd;
+	VariableTable variables(tableVariables, sizeof(tableVariables));
+	cmd.begin(&port, doubleCommands, sizeof(doubleCommands)).attachVariables(variables).commandPrompt(OFF);
+	CHECK_EQUAL("count=42\r\ngain=1.5\r\noffset=-0.125\r\nenabled=1\r\nname=motor\r\n",
+		variableReply(cmd, port, "set count 42 gain 1.5 offset -0.125 enabled true name motor"));
+	CHECK_EQUAL(42, tableInt);
+	CHECK(tableFloat == 1.5f && tableDouble == -0.125 && tableBool && tableString == "motor");
+	CHECK_EQUAL("gain=1.5\r\ncount=42\r\n", variableReply(cmd, port, "get gain count"));
+	CHECK_EQUAL("enabled=0\r\nname=\"left motor\"\r\n", variableReply(cmd, port, "set enabled off name \"left motor\""));
+	CHECK_EQUAL("count=42\r\ngain=1.5\r\noffset=-0.125\r\nenabled=0\r\nname=\"left motor\"\r\n", variableReply(cmd, port, "dump"));
+	//values outside the range are clamped to it
+	CHECK_EQUAL("count=100\r\ngain=0\r\n", variableReply(cmd, port, "set count 500 gain -3"));
+	CHECK_EQUAL(100, tableInt);
+	CHECK_EQUAL("count=-10\r\n", variableReply(cmd, port, "set count -99999999999"));
+	//unknown names and bad values are reported, and the rest of the line is still handled
+	CHECK_EQUAL("#Variable: 'speed' not recognised\r\ncount=7\r\n", variableReply(cmd, port, "set speed 5 count 7"));
+	CHECK_EQUAL("#Variable: 'speed' not recognised\r\ncount=7\r\n", variableReply(cmd, port, "get speed count"));
+	CHECK_EQUAL("#Variable: 'count' bad value\r\nenabled=1\r\n", variableReply(cmd, port, "set count abc enabled 1"));
+	CHECK_EQUAL(7, tableInt);
+	CHECK_EQUAL("#Variable: 'enabled' bad value\r\n", variableReply(cmd, port, "set enabled maybe"));
+	CHECK(tableBool);
+}
+
+//==============================================================================================================
+//watched variables are printed at their period, 'change' only prints values that have changed, and unwatch stops them
+static std::string watchFor(Commander &cmd, MemStream &port, unsigned long ms, unsigned long &elapsed){
+	//run update() for ms milliseconds and return what was printed
+	unsigned long start = millis();
+	while(millis() - start < ms){
+		cmd.update();
+		delay(1);
+	}
+	elapsed = millis() - start;
+	return port.take();
+}
+
+TEST(watchPrintsAtItsPeriod){
+	MemStream port;
+	Commander cmd;
+	VariableTable variables(watchedVariables, sizeof(watchedVariables));
+	cmd.begin(&port, doubleCommands, sizeof(doubleCommands)).attachVariables(variables).commandPrompt(OFF);
+	watchedInt = 10;
+	watchedFloat = 0.5;
+	unsigned long elapsed = 0;
+	//both are due on the same updates so they share a line, and the first line is sent on the next update
+	port.feed("watch speed gain 20\n");
+	cmd.update();
+	CHECK(port.take().empty());
+	cmd.update();
+	CHECK_EQUAL("speed=10 gain=0.5\r\n", port.take());
+	std::string printed = watchFor(cmd, port, 100, elapsed);
+	uint16_t lines = countLines(printed, "speed=10 gain=0.5\r");
+	CHECK(lines >= 2 && lines <= elapsed / 20 + 1);
+	CHECK_EQUAL(lines, countLines(printed, ""));
+	port.feed("watch\n");
+	run(cmd, 3);
+	CHECK(port.take().find("speed 20\r\ngain 20\r\n") != std::string::npos);
+	//with change, a value is only printed again when it changes
+	port.feed("unwatch\nwatch gain 10 change\n");
+	run(cmd, 3);
+	CHECK_EQUAL(1, countLines(port.take() + watchFor(cmd, port, 60, elapsed), "gain=0.5\r"));
+	watchedFloat = 0.75;
+	printed = watchFor(cmd, port, 60, elapsed);
+	CHECK_EQUAL("gain=0.75\r\n", printed);
+	//unwatch stops the named variable, and on its own stops them all
+	port.feed("watch speed 10\nunwatch gain\n");
+	run(cmd, 3);
+	watchedFloat = 1;
+	printed = port.take() + watchFor(cmd, port, 60, elapsed);
+	CHECK(countLines(printed, "speed=10\r") >= 2);
+	CHECK_EQUAL(0, countLines(printed, "gain"));
+	port.feed("unwatch\n");
+	run(cmd, 3);
+	port.take();
+	watchedInt = 11;
+	CHECK(watchFor(cmd, port, 40, elapsed).empty());
+}
+
+//==============================================================================================================
+int main(){
+	return runTests();
+}